@@ -0,0 +1,34 @@
+#include "AllocationCounter.h"
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+atomic<long long> AllocationCounter::count(0);
+
+long long AllocationCounter::getCount() {
+    return count.load(memory_order_relaxed);
+}
+
+void AllocationCounter::add() {
+    count.fetch_add(1, memory_order_relaxed);
+}
+
+// the program's replacements of the global operator new and delete. array and nothrow
+// forms of new call these by default, over-aligned types keep the library's versions
+void* operator new(size_t size) {
+    AllocationCounter::add();
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+    free(memory);
+}
@@ -0,0 +1,19 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <atomic>
+
+using namespace std;
+
+// counts heap allocations made through operator new, on every thread, so benchmarks
+// can check how many allocations a hot path makes. the count costs one relaxed increment
+class AllocationCounter {
+public:
+    static long long getCount();
+    static void add();
+
+private:
+    static atomic<long long> count;
+};
+
+#endif // ALLOCATIONCOUNTER_H
@@ -0,0 +1,291 @@
+#include "Benchmark.h"
+
+using namespace std;
+
+Benchmark::Benchmark(DbProfile profile, const vector<string>& args) : profile(profile), random(42) {
+    this->sizes = { 1, 1000, 100000, 1000000 };
+    this->boardCount = 10;
+    this->dbPath = "kanban_bench.db";
+
+    // bench [--sizes 1,1000,...] [--boards N] [--json file]
+    for (size_t i = 0; i < args.size(); i++) {
+        const string& arg = args[i];
+        if (i + 1 >= args.size()) {
+            throw invalid_argument("Missing value for " + arg);
+        }
+        const string& value = args[++i];
+        if (arg == "--sizes") {
+            this->sizes.clear();
+            stringstream list(value);
+            string size;
+            while (getline(list, size, ',')) {
+                this->sizes.push_back(stoll(size));
+            }
+        }
+        else if (arg == "--boards") {
+            this->boardCount = stoi(value);
+        }
+        else if (arg == "--json") {
+            this->jsonPath = value;
+        }
+        else {
+            throw invalid_argument("Unknown bench option " + arg);
+        }
+    }
+    if (this->sizes.empty() || this->boardCount < 1) {
+        throw invalid_argument("Bench needs at least one size and one board.");
+    }
+}
+
+int Benchmark::run(ostream& output) {
+    for (long long size : this->sizes) {
+        output << "seeding " << size << " tasks on " << this->dbPath << " (" << this->profile.getName() << " profile)" << endl;
+        runSize(size);
+    }
+    printResults(output);
+    if (!this->jsonPath.empty()) {
+        writeJson(this->jsonPath);
+        output << "results written to " << this->jsonPath << endl;
+    }
+    return 0;
+}
+
+// nearest rank percentile of sorted samples
+double Benchmark::percentile(const vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = static_cast<size_t>(fraction * sorted.size());
+    return sorted[min(rank, sorted.size() - 1)];
+}
+
+void Benchmark::runSize(long long size) {
+    removeDatabase(this->dbPath);
+    {
+        // a reader for each thread of the parallel load, the other cases use the writer.
+        // the load is timed on 1, 2 and one thread per core
+        int threadCount = ThreadPool::defaultThreadCount();
+        vector<int> threadCounts = { 1, 2 };
+        if (threadCount > 2) {
+            threadCounts.push_back(threadCount);
+        }
+        ConnectionPool pool(this->dbPath, this->profile, threadCounts.back());
+        Database& db = pool.getWriter();
+        Result inserts = { size, "bulk insert 1000 tasks", {}, 0 };
+        seed(db, size, inserts);
+        this->results.push_back(move(inserts));
+
+        // boards are seeded with the same number of tasks, the first one is used for board cases
+        vector<Board*> boards = db.loadBoardsList();
+        Board* board = boards[0];
+        db.loadStageCounts(*board);
+        int boardTasks = board->getTaskCount();
+        uniform_int_distribution<int> anyTask(0, max(0, boardTasks - 1));
+        vector<Task> firstPage = db.loadTaskPage(*board, -1, 0, 1);
+        int firstId = firstPage.empty() ? 0 : firstPage[0].getId();
+
+        measure(size, "board list load", 200, [&]() {
+            for (Board* loaded : db.loadBoardsList()) {
+                delete loaded;
+            }
+        });
+        measure(size, "board open (counts + first page)", 200, [&]() {
+            db.loadStageCounts(*board);
+            db.loadTaskPage(*board, -1, 0, 200);
+        });
+        measure(size, "task page load", 500, [&]() {
+            // seek from a random id, pages start anywhere in a stage
+            db.loadTaskPage(*board, 1, firstId + anyTask(this->random), 200);
+        });
+        measure(size, "full board task load", (boardTasks > 10000) ? 5 : 50, [&]() {
+            db.loadTaskData(*board);
+        });
+        // lookups in the whole board as the ui holds it. a lookup is too short to time alone,
+        // so a sample is 1000 of them
+        board->setTasks(db.loadTaskData(*board));
+        vector<int> taskIds;
+        for (Task& task : board->getTasks()) {
+            taskIds.push_back(task.getId());
+        }
+        measure(size, "task lookup by id x1000", 200, [&]() {
+            uniform_int_distribution<size_t> anyLoaded(0, max<size_t>(1, taskIds.size()) - 1);
+            for (int i = 0; i < 1000 && !taskIds.empty(); i++) {
+                board->getTaskById(taskIds[anyLoaded(this->random)]);
+            }
+        });
+        // every task of every board as the report loads them, each thread reading through its own reader
+        for (int count : threadCounts) {
+            ThreadPool threads(count);
+            string name = "all boards task load, " + to_string(count) + ((count == 1) ? " thread" : " threads");
+            measure(size, name, (size > 100000) ? 3 : 20, [&]() {
+                pool.loadBoardTasks(boards, threads);
+            });
+        }
+        measure(size, "single edit round trip", 200, [&]() {
+            // load one task, change it and save it in its own transaction
+            vector<Task> found = db.loadTask(*board, firstId + anyTask(this->random));
+            if (!found.empty()) {
+                found[0].setDifficulty(found[0].getDifficulty() % 5 + 1);
+                db.saveTaskData(found[0]);
+            }
+        });
+        Task sample("Benchmark task", *board);
+        sample.setId(1);
+        measure(size, "query string build", 10000, [&]() {
+            map<string, variant<int, string>> dataMap = {
+                { "title", sample.getTitle() },
+                { "description", sample.getDescription() },
+                { "difficulty_rating", sample.getDifficulty() },
+                { "stage_rank", static_cast<int>(sample.getStage()) },
+                { "board_id", sample.getBoardId() },
+                { "id", sample.getId() }
+            };
+            db.statementKey("Tasks", dataMap);
+            db.queryString("Tasks", dataMap);
+        });
+        // each keystroke of a search typed letter by letter, as the search screen runs them
+        vector<string> typing = { "s", "sl", "slo", "slow", "slow c", "slow cr", "slow cra", "slow crash" };
+        size_t keystroke = 0;
+        measure(size, "search keystroke", 400, [&]() {
+            db.searchTasks(typing[keystroke++ % typing.size()], 50);
+        });
+        vector<int> boardIds;
+        for (Board* loaded : boards) {
+            boardIds.push_back(loaded->getId());
+            delete loaded;
+        }
+
+        // render through the real UI into an offscreen buffer of a fixed size
+        UI ui(db, true);
+        ui.getScreen().setSize(40, 120);
+        ui.reloadBoards();
+        ui.setSelectIndex(0);
+        uniform_int_distribution<size_t> anyBoard(0, boardIds.size() - 1);
+        measure(size, "board lookup by id x1000", 200, [&]() {
+            for (int i = 0; i < 1000; i++) {
+                ui.getBoardById(boardIds[anyBoard(this->random)]);
+            }
+        });
+        ui.displayScreen();
+        measure(size, "frame render board list (full redraw)", 500, [&]() {
+            ui.getScreen().invalidate();
+            ui.displayScreen();
+        });
+        ui.handleKey(Terminal::KEY_ENTER); // open the first board
+        ui.displayScreen();
+        measure(size, "frame render board view (full redraw)", 500, [&]() {
+            ui.getScreen().invalidate();
+            ui.displayScreen();
+        });
+        measure(size, "selection move + frame", 1000, [&]() {
+            ui.handleKey(Terminal::KEY_DOWN);
+            ui.displayScreen();
+        });
+        ui.handleKey(Terminal::KEY_ENTER); // open the selected task
+        ui.displayScreen();
+        measure(size, "frame render task card (full redraw)", 500, [&]() {
+            ui.getScreen().invalidate();
+            ui.displayScreen();
+        });
+    }
+    removeDatabase(this->dbPath);
+}
+
+// fill the database with generated boards of equal size, timing each batch of 1000 inserts
+void Benchmark::seed(Database& db, long long size, Result& insertTimes) {
+    Workload workload;
+    workload.setOption("tasks", to_string(size));
+    workload.setOption("boards", to_string(this->boardCount));
+    workload.setOption("seed", "42");
+    for (int b = 0; b < workload.getBoardCount(); b++) {
+        // numbered so the first board in title order is the one with any leftover tasks
+        Board board("Board " + to_string(b + 1));
+        db.saveBoardData(board);
+
+        long long count = workload.tasksForBoard(b);
+        vector<Task> batch;
+        for (long long i = 0; i < count; i++) {
+            batch.push_back(workload.makeTask(board));
+            if (batch.size() == 1000 || i == count - 1) {
+                long long allocationsBefore = AllocationCounter::getCount();
+                auto start = chrono::steady_clock::now();
+                db.saveTasks(batch);
+                auto end = chrono::steady_clock::now();
+                insertTimes.allocations += AllocationCounter::getCount() - allocationsBefore;
+                insertTimes.samples.push_back(chrono::duration<double, micro>(end - start).count());
+                batch.clear();
+            }
+        }
+    }
+}
+
+// time each call of body separately
+void Benchmark::measure(long long size, const string& name, int iterations, const function<void()>& body) {
+    Result result = { size, name, {}, 0 };
+    result.samples.reserve(iterations);
+    for (int i = 0; i < iterations; i++) {
+        long long allocationsBefore = AllocationCounter::getCount();
+        auto start = chrono::steady_clock::now();
+        body();
+        auto end = chrono::steady_clock::now();
+        result.allocations += AllocationCounter::getCount() - allocationsBefore;
+        result.samples.push_back(chrono::duration<double, micro>(end - start).count());
+    }
+    this->results.push_back(move(result));
+}
+
+void Benchmark::printResults(ostream& output) {
+    output << left << setw(9) << "tasks" << setw(40) << "case" << right << setw(7) << "count"
+        << setw(12) << "mean us" << setw(12) << "p50 us" << setw(12) << "p90 us"
+        << setw(12) << "p99 us" << setw(12) << "max us" << setw(12) << "allocs/op" << "\n";
+    output << fixed << setprecision(1);
+    for (Result& result : this->results) {
+        vector<double> sorted = result.samples;
+        sort(sorted.begin(), sorted.end());
+        double total = 0;
+        for (double sample : sorted) {
+            total += sample;
+        }
+        double mean = sorted.empty() ? 0 : total / sorted.size();
+        output << left << setw(9) << result.size << setw(40) << result.name << right << setw(7) << sorted.size()
+            << setw(12) << mean << setw(12) << percentile(sorted, 0.5) << setw(12) << percentile(sorted, 0.9)
+            << setw(12) << percentile(sorted, 0.99) << setw(12) << (sorted.empty() ? 0 : sorted.back())
+            << setw(12) << (sorted.empty() ? 0 : static_cast<double>(result.allocations) / sorted.size()) << "\n";
+    }
+    output << defaultfloat << setprecision(6);
+}
+
+// one object per case and size, for comparing runs
+void Benchmark::writeJson(const string& path) {
+    ofstream file(path);
+    if (!file) {
+        throw runtime_error("Can't write benchmark results to " + path);
+    }
+    file << fixed << setprecision(2);
+    file << "{\"profile\": \"" << this->profile.getName() << "\", \"results\": [\n";
+    for (size_t i = 0; i < this->results.size(); i++) {
+        Result& result = this->results[i];
+        vector<double> sorted = result.samples;
+        sort(sorted.begin(), sorted.end());
+        double total = 0;
+        for (double sample : sorted) {
+            total += sample;
+        }
+        file << "  {\"tasks\": " << result.size << ", \"case\": \"" << result.name << "\""
+            << ", \"count\": " << sorted.size()
+            << ", \"mean_us\": " << (sorted.empty() ? 0 : total / sorted.size())
+            << ", \"p50_us\": " << percentile(sorted, 0.5)
+            << ", \"p90_us\": " << percentile(sorted, 0.9)
+            << ", \"p99_us\": " << percentile(sorted, 0.99)
+            << ", \"max_us\": " << (sorted.empty() ? 0 : sorted.back())
+            << ", \"allocs_per_op\": " << (sorted.empty() ? 0 : static_cast<double>(result.allocations) / sorted.size()) << "}"
+            << ((i + 1 < this->results.size()) ? "," : "") << "\n";
+    }
+    file << "]}\n";
+}
+
+void Benchmark::removeDatabase(const string& path) {
+    remove(path.c_str());
+    remove((path + "-wal").c_str());
+    remove((path + "-shm").c_str());
+}
@@ -0,0 +1,59 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Database.h"
+#include "ConnectionPool.h"
+#include "ThreadPool.h"
+#include "DbProfile.h"
+#include "UI.h"
+#include "Workload.h"
+#include "AllocationCounter.h"
+#include "Board.h"
+#include "Task.h"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// times the database, model and rendering hot paths on generated databases of several sizes
+class Benchmark {
+public:
+    // timings of one case at one database size, in microseconds
+    struct Result {
+        long long size;
+        string name;
+        vector<double> samples;
+        long long allocations; // heap allocations over all iterations
+    };
+
+    Benchmark(DbProfile profile, const vector<string>& args);
+    int run(ostream& output);
+    static double percentile(const vector<double>& sorted, double fraction);
+
+private:
+    void runSize(long long size);
+    void seed(Database& db, long long size, Result& insertTimes);
+    void measure(long long size, const string& name, int iterations, const function<void()>& body);
+    void printResults(ostream& output);
+    void writeJson(const string& path);
+    static void removeDatabase(const string& path);
+
+    DbProfile profile;
+    vector<long long> sizes; // total tasks in each generated database
+    int boardCount; // tasks are spread over this many boards
+    string jsonPath; // machine readable results, empty for none
+    string dbPath; // generated database, removed after each size
+    mt19937 random; // fixed seed, every run picks the same tasks
+    vector<Result> results;
+};
+
+#endif // BENCHMARK_H
@@ -2,63 +2,236 @@
 
 using namespace std;
 
-Board::Board(string title) : title(title) {
-    if (title.empty()) {
+Board::Board(string title) : title(move(title)) {
+    if (this->title.empty()) {
         throw invalid_argument("Title can't be empty.");
     }
     this->id = 0;
+    this->windowStart = 0;
+    this->stageCounts[0] = this->stageCounts[1] = this->stageCounts[2] = 0;
+    this->totalDifficulty = 0;
 }
 
 Board::~Board() {
-    // Deallocate and clear assigned tasks list
-    for (auto task : this->tasks) {
-        delete task;
-    }
-    this->tasks.clear();
+    // tasks are stored by value, no pointers to deallocate
 }
 
 void Board::setId(const int id) {
     this->id = id;
 }
 
-void Board::setTitle(const string newTitle) {
+void Board::setTitle(string newTitle) {
     if (newTitle.empty()) {
         throw invalid_argument("Title can't be empty.");
     }
     else if (newTitle.length() > 50) { // char limit on title
         throw invalid_argument("Title can't exceed 50 characters.");
     }
-    this->title = newTitle;
+    this->title = move(newTitle);
+}
+
+void Board::setTasks(vector<Task> tasks) {
+    // replace current tasks with every task of the board
+    setWindow(0, move(tasks));
+
+    // count tasks per stage and add up their ratings
+    this->stageCounts[0] = this->stageCounts[1] = this->stageCounts[2] = 0;
+    this->totalDifficulty = 0;
+    for (Task& task : this->tasks) {
+        this->stageCounts[static_cast<int>(task.getStage())]++;
+        this->totalDifficulty += task.getDifficulty();
+    }
+}
+
+void Board::setWindow(int start, vector<Task> tasks) {
+    // replace current tasks with a page of the board, stage counts and the rating total are set separately
+    Stats::add(Stats::Counter::TasksFreed, static_cast<long long>(this->tasks.size()));
+    Stats::add(Stats::Counter::TasksAllocated, static_cast<long long>(tasks.size()));
+    this->windowStart = start;
+    this->tasks = move(tasks);
+    this->taskIndex.clear();
+    this->taskIndex.reserve(this->tasks.size());
+    indexTasksFrom(0);
 }
 
-void Board::setTasks(const list<Task*>& tasks) {
-    // deallocate and clear current list
-    for (auto task : this->tasks) {
-        delete task;
+void Board::appendTasks(vector<Task> tasks) {
+    // add the page that follows the loaded window
+    Stats::add(Stats::Counter::TasksAllocated, static_cast<long long>(tasks.size()));
+    size_t position = this->tasks.size();
+    this->tasks.insert(this->tasks.end(), make_move_iterator(tasks.begin()), make_move_iterator(tasks.end()));
+    indexTasksFrom(position);
+}
+
+void Board::prependTasks(vector<Task> tasks) {
+    // add the page that comes before the loaded window
+    Stats::add(Stats::Counter::TasksAllocated, static_cast<long long>(tasks.size()));
+    this->windowStart -= static_cast<int>(tasks.size());
+    this->tasks.insert(this->tasks.begin(), make_move_iterator(tasks.begin()), make_move_iterator(tasks.end()));
+    indexTasksFrom(0);
+}
+
+void Board::trimTasks(int first, int last) {
+    // keep only board positions first to last (exclusive) of the loaded window
+    first = max(first, this->windowStart);
+    last = max(first, min(last, getWindowEnd()));
+    size_t keepFrom = static_cast<size_t>(first - this->windowStart);
+    size_t keepTo = static_cast<size_t>(last - this->windowStart);
+
+    for (size_t i = 0; i < this->tasks.size(); i++) {
+        if (i < keepFrom || i >= keepTo) {
+            this->taskIndex.erase(this->tasks[i].getId());
+        }
     }
-    this->tasks.clear();
-    // set new list
-    this->tasks = tasks;
+    Stats::add(Stats::Counter::TasksFreed, static_cast<long long>(this->tasks.size() - (keepTo - keepFrom)));
+    this->tasks.erase(this->tasks.begin() + keepTo, this->tasks.end());
+    this->tasks.erase(this->tasks.begin(), this->tasks.begin() + keepFrom);
+    this->windowStart = first;
+    indexTasksFrom(0);
+}
+
+void Board::setStageCounts(int toDo, int inProgress, int done) {
+    this->stageCounts[0] = toDo;
+    this->stageCounts[1] = inProgress;
+    this->stageCounts[2] = done;
+}
+
+void Board::setTotalDifficulty(int total) {
+    this->totalDifficulty = total;
 }
 
 int Board::getId() {
     return this->id;
 }
 
-string Board::getTitle() {
+const string& Board::getTitle() {
     return this->title;
 }
 
-list<Task*>& Board::getTasks() {
+vector<Task>& Board::getTasks() {
     return this->tasks;
 }
 
 Task* Board::getTaskById(int id) {
-    for (Task* task : tasks) {
-        if (task->getId() == id) {
-            return task;
-        }
+    auto found = this->taskIndex.find(id);
+    if (found != this->taskIndex.end()) {
+        return &this->tasks[found->second];
     }
     throw runtime_error("Task with id " + to_string(id) + " not found.");
     return nullptr;
 }
+
+Task& Board::getTaskAt(int position) {
+    // task at a board position, which must be inside the loaded window
+    if (!isLoaded(position)) {
+        throw runtime_error("Task at position " + to_string(position) + " is not loaded.");
+    }
+    return this->tasks[position - this->windowStart];
+}
+
+bool Board::isLoaded(int position) {
+    return position >= this->windowStart && position < getWindowEnd();
+}
+
+int Board::getWindowStart() {
+    return this->windowStart;
+}
+
+int Board::getWindowEnd() {
+    return this->windowStart + static_cast<int>(this->tasks.size());
+}
+
+int Board::getTaskCount() {
+    return this->stageCounts[0] + this->stageCounts[1] + this->stageCounts[2];
+}
+
+int Board::getStageCount(Stage stage) {
+    return this->stageCounts[static_cast<int>(stage)];
+}
+
+int Board::getTotalDifficulty() {
+    return this->totalDifficulty;
+}
+
+bool Board::addTask(Task task) {
+    // insert in the same stage, id order tasks are loaded in.
+    // returns false when the task belongs outside the loaded window and is not kept
+    size_t position = 0;
+    while (position < this->tasks.size() && isOrderedBefore(this->tasks[position], task)) {
+        position++;
+    }
+    this->stageCounts[static_cast<int>(task.getStage())]++;
+    this->totalDifficulty += task.getDifficulty();
+
+    if (position == 0 && this->windowStart > 0) {
+        // sorts before the window, which moves down one position
+        this->windowStart++;
+        return false;
+    }
+    if (position == this->tasks.size() && getWindowEnd() < getTaskCount() - 1) {
+        // sorts after the window, past tasks that are not loaded
+        return false;
+    }
+    this->tasks.insert(this->tasks.begin() + position, move(task));
+    indexTasksFrom(position);
+    return true;
+}
+
+void Board::removeTask(int id) {
+    auto found = this->taskIndex.find(id);
+    if (found == this->taskIndex.end()) {
+        throw runtime_error("Task with id " + to_string(id) + " not found.");
+    }
+    size_t position = found->second;
+    this->stageCounts[static_cast<int>(this->tasks[position].getStage())]--;
+    this->totalDifficulty -= this->tasks[position].getDifficulty();
+    this->taskIndex.erase(found);
+    this->tasks.erase(this->tasks.begin() + position);
+    indexTasksFrom(position);
+}
+
+void Board::rateTask(int id, int rating) {
+    // change a task's rating, keeping the board's total in step
+    Task* task = getTaskById(id);
+    int previous = task->getDifficulty();
+    task->setDifficulty(rating); // throws before the total changes
+    this->totalDifficulty += rating - previous;
+}
+
+bool Board::changeStage(int id, Stage newStage) {
+    // move a task to a new stage and its sorted place there, counted out of its old stage
+    // and into the new one. returns false when that place is outside the loaded window
+    Task task = *getTaskById(id);
+    task.setStage(newStage, false); // throws before the board changes
+    removeTask(id);
+    bool kept = addTask(move(task));
+    assert(countsMatchTasks());
+    return kept;
+}
+
+bool Board::isOrderedBefore(Task& first, Task& second) {
+    // tasks are ordered by stage, then by id within a stage
+    if (first.getStage() != second.getStage()) {
+        return first.getStage() < second.getStage();
+    }
+    return first.getId() < second.getId();
+}
+
+bool Board::countsMatchTasks() {
+    // with the whole board loaded, the stage counts are the tasks of each stage.
+    // a window can't be checked, the tasks outside it aren't here
+    if (this->windowStart != 0 || this->tasks.size() != static_cast<size_t>(getTaskCount())) {
+        return true;
+    }
+    int counts[3] = { 0, 0, 0 };
+    for (Task& task : this->tasks) {
+        counts[static_cast<int>(task.getStage())]++;
+    }
+    return counts[0] == this->stageCounts[0] && counts[1] == this->stageCounts[1] && counts[2] == this->stageCounts[2];
+}
+
+void Board::indexTasksFrom(size_t position) {
+    // positions shift after an insert or erase, update index entries from there on
+    for (size_t i = position; i < this->tasks.size(); i++) {
+        this->taskIndex[this->tasks[i].getId()] = i;
+    }
+}
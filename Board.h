@@ -2,10 +2,14 @@
 #define BOARD_H
 
 #include "Task.h"
+#include "Stats.h"
 #include <stdexcept>
+#include <cassert>
 #include <iostream>
 #include <string>
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 using namespace std;
 
@@ -16,17 +20,45 @@ public:
     Board(string title);
     ~Board();
     void setId(const int id);
-    void setTitle(const string newTitle);
-    void setTasks(const list<Task*>& tasks);
+    void setTitle(string newTitle);
+    void setTasks(vector<Task> tasks);
+    void setWindow(int start, vector<Task> tasks);
+    void appendTasks(vector<Task> tasks);
+    void prependTasks(vector<Task> tasks);
+    void trimTasks(int first, int last);
+    void setStageCounts(int toDo, int inProgress, int done);
+    void setTotalDifficulty(int total);
     int getId();
-    string getTitle();
-    list<Task*>& getTasks();
+    const string& getTitle();
+    vector<Task>& getTasks();
     Task* getTaskById(int id);
+    Task& getTaskAt(int position);
+    bool isLoaded(int position);
+    int getWindowStart();
+    int getWindowEnd();
+    int getTaskCount();
+    int getStageCount(Stage stage);
+    int getTotalDifficulty();
+    bool addTask(Task task);
+    void removeTask(int id);
+    void rateTask(int id, int rating);
+    bool changeStage(int id, Stage newStage);
+    static bool isOrderedBefore(Task& first, Task& second);
 
 private:
+    void indexTasksFrom(size_t position);
+    bool countsMatchTasks();
+
     int id;
     string title;
-    list<Task*> tasks;
+    // tasks stored by value in stage, id order. task ids are the stable handles,
+    // pointers from getTaskById are only valid until the next change to the board.
+    // tasks may hold only a window of the board, starting at board position windowStart
+    vector<Task> tasks;
+    unordered_map<int, size_t> taskIndex; // task id to position in tasks
+    int windowStart;
+    int stageCounts[3]; // number of tasks in each stage, loaded or not
+    int totalDifficulty; // sum of the difficulty ratings of all tasks, loaded or not
 };
 
 #endif // BOARD_H
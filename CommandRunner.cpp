@@ -0,0 +1,291 @@
+#include "CommandRunner.h"
+
+using namespace std;
+
+CommandRunner::CommandRunner(Database& db, ostream& output) : db(db), output(output) {
+    this->lastBoardId = 0;
+    this->lastTaskId = 0;
+    this->commandCount = 0;
+
+    // boards are few, keep them all loaded. tasks are loaded one at a time when a command needs them
+    for (Board* board : this->db.loadBoardsList()) {
+        this->boards[board->getId()] = board;
+    }
+}
+
+CommandRunner::~CommandRunner() {
+    // roll back anything not committed, then free loaded boards
+    this->batch.reset();
+    for (auto& entry : this->boards) {
+        delete entry.second;
+    }
+}
+
+// run every command in the stream, one per line. returns the number of failed commands
+int CommandRunner::run(istream& input) {
+    auto start = chrono::steady_clock::now();
+    int errors = 0;
+    int lineNumber = 0;
+    int pending = 0; // commands in the open transaction
+    string line;
+
+    this->batch = make_unique<Database::Batch>(this->db);
+    while (getline(input, line)) {
+        lineNumber++;
+        try {
+            vector<string> args = splitCommand(line);
+            if (args.empty()) {
+                continue; // blank line or comment
+            }
+            runCommand(args);
+            this->commandCount++;
+        }
+        catch (const exception& e) {
+            // a bad command is reported and skipped, the rest of the script still runs
+            cerr << "line " << lineNumber << ": " << e.what() << endl;
+            errors++;
+        }
+        // group commands into transactions instead of one commit per command
+        if (++pending >= BATCH_SIZE) {
+            this->batch->commit();
+            this->batch = make_unique<Database::Batch>(this->db);
+            pending = 0;
+        }
+    }
+    this->batch->commit();
+    this->batch.reset();
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cerr << this->commandCount << " commands in " << seconds * 1000 << " ms, "
+        << static_cast<long long>(this->commandCount / max(seconds, 1e-9)) << " ops/sec, "
+        << errors << " errors" << endl;
+    return errors;
+}
+
+void CommandRunner::runCommand(const vector<string>& args) {
+    const string& command = args[0];
+    size_t count = args.size();
+
+    if (command == "board" && count == 2) {
+        // create a board, the new id is printed for the script
+        Board* board = new Board(args[1]);
+        try {
+            board->setTitle(args[1]); // title length is checked by the setter
+            this->db.saveBoardData(*board);
+        }
+        catch (...) {
+            delete board;
+            throw;
+        }
+        this->boards[board->getId()] = board;
+        this->lastBoardId = board->getId();
+        this->output << "board " << board->getId() << "\n";
+    }
+    else if (command == "rename-board" && count == 3) {
+        Board* board = findBoard(args[1]);
+        string oldTitle = board->getTitle();
+        board->setTitle(args[2]);
+        try {
+            this->db.saveBoardData(*board);
+        }
+        catch (...) {
+            board->setTitle(move(oldTitle));
+            throw;
+        }
+    }
+    else if (command == "delete-board" && count == 2) {
+        Board* board = findBoard(args[1]);
+        this->db.deleteBoard(*board);
+        this->boards.erase(board->getId());
+        delete board;
+    }
+    else if (command == "task" && count >= 3 && count <= 5) {
+        // task <board> <title> [description] [difficulty]
+        Board* board = findBoard(args[1]);
+        Task task(args[2], *board);
+        if (count >= 4) {
+            task.setDescription(args[3]);
+        }
+        if (count == 5) {
+            task.setDifficulty(parseNumber(args[4]));
+        }
+        task.validate();
+        this->db.saveTaskData(task);
+        this->lastTaskId = task.getId();
+        this->output << "task " << task.getId() << "\n";
+    }
+    else if (command == "title" && count == 3) {
+        Task task = loadTask(args[1]);
+        task.setTitle(args[2]);
+        this->db.saveTaskData(task);
+    }
+    else if (command == "describe" && count == 3) {
+        Task task = loadTask(args[1]);
+        task.setDescription(args[2]);
+        this->db.saveTaskData(task);
+    }
+    else if (command == "stage" && count == 3) {
+        // stage by name, or by number like the stage menu
+        Task task = loadTask(args[1]);
+        const string& stage = args[2];
+        if (stage == "1" || stage == "2" || stage == "3") {
+            task.setStage(static_cast<Stage>(stage[0] - '1'), false);
+        }
+        else {
+            task.setStage(Task::stringToStage(stage), false);
+        }
+        this->db.saveTaskData(task);
+    }
+    else if (command == "rate" && count == 3) {
+        Task task = loadTask(args[1]);
+        task.setDifficulty(parseNumber(args[2]));
+        this->db.saveTaskData(task);
+    }
+    else if (command == "delete-task" && count == 2) {
+        Task task = loadTask(args[1]);
+        this->db.deleteTask(task);
+    }
+    else if (command == "list" && count == 1) {
+        listBoards();
+    }
+    else if (command == "list" && count == 2) {
+        listTasks(findBoard(args[1]));
+    }
+    else if (command == "commit" && count == 1) {
+        // end the transaction here, e.g. to make earlier commands visible to another reader
+        this->batch->commit();
+        this->batch = make_unique<Database::Batch>(this->db);
+    }
+    else {
+        throw invalid_argument("Unknown command or wrong number of arguments: " + command);
+    }
+}
+
+// split a line into words. double quotes group words, \" is a quote inside them, # starts a comment
+vector<string> CommandRunner::splitCommand(const string& line) {
+    vector<string> args;
+    string word;
+    bool inWord = false;
+    bool quoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (quoted) {
+            if (c == '\\' && i + 1 < line.size() && (line[i + 1] == '"' || line[i + 1] == '\\')) {
+                word += line[++i];
+            }
+            else if (c == '"') {
+                quoted = false;
+            }
+            else {
+                word += c;
+            }
+        }
+        else if (c == '"') {
+            quoted = true;
+            inWord = true;
+        }
+        else if (c == '#' && !inWord) {
+            break;
+        }
+        else if (c == ' ' || c == '\t' || c == '\r') {
+            if (inWord) {
+                args.push_back(move(word));
+                word.clear();
+                inWord = false;
+            }
+        }
+        else {
+            word += c;
+            inWord = true;
+        }
+    }
+    if (quoted) {
+        throw invalid_argument("Missing closing quote.");
+    }
+    if (inWord) {
+        args.push_back(move(word));
+    }
+    return args;
+}
+
+long long CommandRunner::getCommandCount() {
+    return this->commandCount;
+}
+
+Board* CommandRunner::findBoard(const string& arg) {
+    int id = parseId(arg, "$board", this->lastBoardId);
+    auto found = this->boards.find(id);
+    if (found == this->boards.end()) {
+        throw invalid_argument("No board with id " + arg + ".");
+    }
+    return found->second;
+}
+
+Task CommandRunner::loadTask(const string& arg) {
+    // find the task's board first, tasks are loaded through their board
+    int id = parseId(arg, "$task", this->lastTaskId);
+    int boardId = this->db.findTaskBoardId(id);
+    auto found = this->boards.find(boardId);
+    if (boardId == 0 || found == this->boards.end()) {
+        throw invalid_argument("No task with id " + arg + ".");
+    }
+    vector<Task> tasks = this->db.loadTask(*found->second, id);
+    if (tasks.empty()) {
+        throw invalid_argument("No task with id " + arg + ".");
+    }
+    return move(tasks[0]);
+}
+
+// an id number, or lastName ($board or $task) for the id made by the last create command
+int CommandRunner::parseId(const string& arg, const string& lastName, int lastId) {
+    if (arg == lastName) {
+        if (lastId == 0) {
+            throw invalid_argument(arg + " used before anything was created.");
+        }
+        return lastId;
+    }
+    int id = parseNumber(arg);
+    if (id <= 0) {
+        throw invalid_argument("Expected an id, got '" + arg + "'.");
+    }
+    return id;
+}
+
+// the whole argument as a number, stoi alone accepts trailing text
+int CommandRunner::parseNumber(const string& arg) {
+    size_t used = 0;
+    int number = 0;
+    try {
+        number = stoi(arg, &used);
+    }
+    catch (const logic_error&) {
+        used = 0;
+    }
+    if (used == 0 || used != arg.size()) {
+        throw invalid_argument("Expected a number, got '" + arg + "'.");
+    }
+    return number;
+}
+
+void CommandRunner::listBoards() {
+    // id, task count and title, tab separated
+    for (auto& entry : this->boards) {
+        Board* board = entry.second;
+        this->db.loadStageCounts(*board);
+        this->output << board->getId() << "\t" << board->getTaskCount() << "\t" << board->getTitle() << "\n";
+    }
+}
+
+void CommandRunner::listTasks(Board* board) {
+    // id, stage, difficulty and title, tab separated, read a page at a time in board order
+    const int pageSize = 1000;
+    vector<Task> page = this->db.loadTaskPage(*board, -1, 0, pageSize);
+    while (!page.empty()) {
+        for (Task& task : page) {
+            this->output << task.getId() << "\t" << Task::stageToString(task.getStage()) << "\t"
+                << task.getDifficulty() << "\t" << task.getTitle() << "\n";
+        }
+        Task& last = page.back();
+        page = this->db.loadTaskPage(*board, static_cast<int>(last.getStage()), last.getId(), pageSize);
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef COMMANDRUNNER_H
+#define COMMANDRUNNER_H
+
+#include "Database.h"
+#include "Board.h"
+#include "Task.h"
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+// runs text commands against the database without the interactive screen, for scripts
+class CommandRunner {
+public:
+    static const int BATCH_SIZE = 1000; // commands per transaction
+
+    CommandRunner(Database& db, ostream& output);
+    ~CommandRunner();
+    CommandRunner(const CommandRunner&) = delete;
+    CommandRunner& operator=(const CommandRunner&) = delete;
+    int run(istream& input);
+    void runCommand(const vector<string>& args);
+    static vector<string> splitCommand(const string& line);
+    long long getCommandCount();
+
+private:
+    Board* findBoard(const string& arg);
+    Task loadTask(const string& arg);
+    int parseId(const string& arg, const string& lastName, int lastId);
+    static int parseNumber(const string& arg);
+    void listBoards();
+    void listTasks(Board* board);
+
+    Database& db;
+    ostream& output;
+    unique_ptr<Database::Batch> batch; // open transaction, committed every BATCH_SIZE commands
+    map<int, Board*> boards; // board id to loaded board, listed in id order
+    int lastBoardId; // id made by the last board command, used for $board
+    int lastTaskId; // id made by the last task command, used for $task
+    long long commandCount;
+};
+
+#endif // COMMANDRUNNER_H
@@ -0,0 +1,88 @@
+#include "ConnectionPool.h"
+
+using namespace std;
+
+ConnectionPool::ConnectionPool(const string& dbPath, DbProfile profile, int readerCount) : writer(dbPath, profile) {
+    this->waitCount = 0;
+    for (int i = 0; i < readerCount; i++) {
+        this->readers.push_back(make_unique<Database>(dbPath, profile, true));
+        this->idle.push_back(this->readers.back().get());
+    }
+}
+
+// the one connection that writes, for the thread doing the saving
+Database& ConnectionPool::getWriter() {
+    return this->writer;
+}
+
+int ConnectionPool::getReaderCount() {
+    return static_cast<int>(this->readers.size());
+}
+
+long long ConnectionPool::getWaitCount() {
+    lock_guard<mutex> lock(this->idleMutex);
+    return this->waitCount;
+}
+
+// load every task of each board, the boards spread over the thread pool. each job reads through
+// a reader of its own, so the loads run side by side. results are in the order of boards
+vector<vector<Task>> ConnectionPool::loadBoardTasks(vector<Board*>& boards, ThreadPool& threads) {
+    if (this->readers.empty()) {
+        throw runtime_error("Loading boards in parallel needs a pool with readers.");
+    }
+    // the biggest boards go first so one isn't left running alone at the end
+    vector<size_t> order(boards.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(), [&boards](size_t a, size_t b) {
+        return boards[a]->getTaskCount() > boards[b]->getTaskCount();
+    });
+
+    vector<vector<Task>> tasks(boards.size());
+    threads.run(order.size(), [this, &boards, &order, &tasks](size_t job) {
+        size_t index = order[job];
+        Lease reader(*this);
+        tasks[index] = reader->loadTaskData(*boards[index]);
+    });
+    return tasks;
+}
+
+// take an idle reader, waiting for one to come back when all are lent
+Database* ConnectionPool::acquire() {
+    unique_lock<mutex> lock(this->idleMutex);
+    if (this->readers.empty()) {
+        throw runtime_error("The connection pool has no readers.");
+    }
+    if (this->idle.empty()) {
+        this->waitCount++;
+        this->returned.wait(lock, [this]() { return !this->idle.empty(); });
+    }
+    Database* reader = this->idle.back();
+    this->idle.pop_back();
+    return reader;
+}
+
+void ConnectionPool::release(Database* reader) {
+    {
+        lock_guard<mutex> lock(this->idleMutex);
+        this->idle.push_back(reader);
+    }
+    this->returned.notify_one();
+}
+
+ConnectionPool::Lease::Lease(ConnectionPool& pool) : pool(pool) {
+    this->reader = pool.acquire();
+}
+
+ConnectionPool::Lease::~Lease() {
+    this->pool.release(this->reader);
+}
+
+Database& ConnectionPool::Lease::operator*() {
+    return *this->reader;
+}
+
+Database* ConnectionPool::Lease::operator->() {
+    return this->reader;
+}
@@ -0,0 +1,60 @@
+#ifndef CONNECTIONPOOL_H
+#define CONNECTIONPOOL_H
+
+#include "Database.h"
+#include "DbProfile.h"
+#include "ThreadPool.h"
+#include "Board.h"
+#include "Task.h"
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// every connection to one database file. the single writer is opened first and sets up the
+// schema, then read-only connections that are lent to one thread at a time. in wal mode the
+// readers keep reading while the writer commits. connections live as long as the pool
+class ConnectionPool {
+public:
+    // a reader borrowed from the pool, given back when the lease ends
+    class Lease {
+    public:
+        Lease(ConnectionPool& pool);
+        ~Lease();
+        // gives the reader back once, so copies are not allowed
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Database& operator*();
+        Database* operator->();
+
+    private:
+        ConnectionPool& pool;
+        Database* reader;
+    };
+
+    ConnectionPool(const string& dbPath, DbProfile profile, int readerCount);
+    // owns the sqlite connections, so copies are not allowed
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+    Database& getWriter();
+    int getReaderCount();
+    long long getWaitCount();
+    vector<vector<Task>> loadBoardTasks(vector<Board*>& boards, ThreadPool& threads);
+
+private:
+    Database* acquire();
+    void release(Database* reader);
+
+    Database writer; // opened first, before any reader
+    vector<unique_ptr<Database>> readers; // owned here and only lent out
+    mutex idleMutex;
+    condition_variable returned; // acquire waits here when every reader is lent
+    vector<Database*> idle; // readers not lent out
+    long long waitCount; // acquires that had to wait, guarded by idleMutex
+};
+
+#endif // CONNECTIONPOOL_H
@@ -2,31 +2,213 @@
 
 using namespace std;
 
+// Tasks table layout, stage stored as its rank in the Stage enum so it sorts in board order
+static string tasksTableSql(const string& tableName) {
+    return "CREATE TABLE " + tableName + " ("
+        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+        "title TEXT NOT NULL,"
+        "description TEXT,"
+        "stage_rank INTEGER NOT NULL CHECK(stage_rank BETWEEN 0 AND 2),"
+        "difficulty_rating INTEGER,"
+        "board_id INTEGER NOT NULL,"
+        "FOREIGN KEY(board_id) REFERENCES Boards(id) ON DELETE CASCADE"
+        ");";
+}
+
+// board order index, board loads and stage counts read it without sorting.
+// also finds a board's tasks for the cascading delete. the rating makes it cover the
+// board summaries, which then never read the table
+static const string TASKS_INDEX_SQL = "CREATE INDEX IF NOT EXISTS idx_tasks_board_order ON Tasks(board_id, stage_rank, id, difficulty_rating);";
+
+// full text index over task titles and descriptions. it reads the text from Tasks itself
+// (external content), the triggers keep its index in step with every change to Tasks
+static const vector<string> SEARCH_SCHEMA_SQL = {
+    "CREATE VIRTUAL TABLE TasksSearch USING fts5(title, description, "
+        "content = 'Tasks', content_rowid = 'id', tokenize = 'unicode61 remove_diacritics 2', prefix = '2 3');",
+    "CREATE TRIGGER TasksSearchInsert AFTER INSERT ON Tasks BEGIN "
+        "INSERT INTO TasksSearch(rowid, title, description) VALUES (new.id, new.title, new.description); END;",
+    "CREATE TRIGGER TasksSearchDelete AFTER DELETE ON Tasks BEGIN "
+        "INSERT INTO TasksSearch(TasksSearch, rowid, title, description) VALUES ('delete', old.id, old.title, old.description); END;",
+    // stage and rating changes leave the text alone and skip the index
+    "CREATE TRIGGER TasksSearchUpdate AFTER UPDATE OF title, description ON Tasks BEGIN "
+        "INSERT INTO TasksSearch(TasksSearch, rowid, title, description) VALUES ('delete', old.id, old.title, old.description); "
+        "INSERT INTO TasksSearch(rowid, title, description) VALUES (new.id, new.title, new.description); END;"
+};
+
+// state for the tokenizer callbacks of search_score
+struct ScoreTokens {
+    string prefix; // typed word as the tokenizer folds it
+    bool found;
+};
+
+static int foldPrefix(void* state, int, const char* token, int length, int, int) {
+    static_cast<ScoreTokens*>(state)->prefix.assign(token, length);
+    return SQLITE_DONE; // only the first token is wanted
+}
+
+static int findPrefix(void* state, int, const char* token, int length, int, int) {
+    ScoreTokens* tokens = static_cast<ScoreTokens*>(state);
+    if (tokens->prefix.compare(0, string::npos, token, min(static_cast<size_t>(length), tokens->prefix.size())) == 0
+        && static_cast<size_t>(length) >= tokens->prefix.size()) {
+        tokens->found = true;
+        return SQLITE_DONE;
+    }
+    return SQLITE_OK;
+}
+
+// search_score(TasksSearch, typed): ranks a match like bm25 without its weight for how rare each
+// word is, which takes a walk over every match of the word. title words count double. when typed
+// is given, a word of the task must start with it or the score is NULL
+static void searchScore(const Fts5ExtensionApi* api, Fts5Context* fts, sqlite3_context* context, int argc, sqlite3_value** argv) {
+    const char* typed = (argc > 0) ? reinterpret_cast<const char*>(sqlite3_value_text(argv[0])) : nullptr;
+    if (typed != nullptr && typed[0] != '\0') {
+        ScoreTokens tokens = { "", false };
+        api->xTokenize(fts, typed, sqlite3_value_bytes(argv[0]), &tokens, foldPrefix);
+        for (int column = 0; column < api->xColumnCount(fts) && !tokens.found; column++) {
+            const char* text;
+            int length;
+            if (api->xColumnText(fts, column, &text, &length) == SQLITE_OK && length > 0) {
+                api->xTokenize(fts, text, length, &tokens, findPrefix);
+            }
+        }
+        if (!tokens.found) {
+            sqlite3_result_null(context);
+            return;
+        }
+    }
+
+    const double columnWeights[] = { 2.0, 1.0 }; // title, description
+    vector<double> frequencies(api->xPhraseCount(fts), 0.0);
+    int instances = 0;
+    api->xInstCount(fts, &instances);
+    for (int i = 0; i < instances; i++) {
+        int phrase, column, offset;
+        if (api->xInst(fts, i, &phrase, &column, &offset) == SQLITE_OK) {
+            frequencies[phrase] += columnWeights[min(column, 1)];
+        }
+    }
+    sqlite3_int64 rows = 0, totalSize = 0;
+    int size = 0;
+    api->xRowCount(fts, &rows);
+    api->xColumnTotalSize(fts, -1, &totalSize);
+    api->xColumnSize(fts, -1, &size);
+    double averageSize = (rows > 0 && totalSize > 0) ? static_cast<double>(totalSize) / rows : 1.0;
+
+    // bm25 term frequency part, k1 = 1.2 and b = 0.75
+    double score = 0;
+    for (double frequency : frequencies) {
+        score += frequency * 2.2 / (frequency + 1.2 * (0.25 + 0.75 * size / averageSize));
+    }
+    sqlite3_result_double(context, score);
+}
+
+// add search_score to the connection, fts5 auxiliary functions go through its api pointer
+static void registerSearchScore(sqlite3* db) {
+    fts5_api* api = nullptr;
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT fts5(?1);", -1, &stmt, nullptr) == SQLITE_OK) {
+        sqlite3_bind_pointer(stmt, 1, &api, "fts5_api_ptr", nullptr);
+        sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    if (api == nullptr || api->xCreateFunction(api, "search_score", nullptr, searchScore, nullptr) != SQLITE_OK) {
+        throw runtime_error("This sqlite build has no fts5, which task search needs.");
+    }
+}
+
 // Constructor 
-Database::Database(string dbName) : dbName(dbName) {
-    int resultCode = sqlite3_open(dbName.c_str(), &db);
+Database::Database(string dbName, DbProfile profile, bool readOnly) : dbName(dbName) {
+    this->cacheHits = 0;
+    this->cacheMisses = 0;
+    this->checkpointMode = profile.getCheckpoint();
+    this->readOnly = readOnly;
+
+    int flags = readOnly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    int resultCode = sqlite3_open_v2(dbName.c_str(), &db, flags, nullptr);
     if (resultCode != SQLITE_OK) {
-        sqlite3_close(db);
+        // the message belongs to the handle, copy it before closing
         string errorMsg = "Error opening database: " + string(sqlite3_errmsg(db));
+        sqlite3_close(db);
         throw runtime_error(errorMsg);
     }
 
-    // Setup tables if not already created
+    registerSearchScore(db);
+
+    // journal, sync and cache settings go first, journal mode can't change inside a transaction
+    for (const string& pragma : profile.getPragmas()) {
+        // the journal mode is stored in the file, a reader can't change it and uses the writer's
+        if (readOnly && pragma.rfind("PRAGMA journal_mode", 0) == 0) {
+            continue;
+        }
+        runPragma(pragma);
+    }
+
+    if (readOnly) {
+        return; // the writer sets up the tables, a reader only needs them to exist
+    }
+
+    // Setup tables if not already created, or bring older layouts up to date
     createTables();
+
+    // sqlite leaves foreign keys off unless asked, needed for cascading board deletes.
+    // set after the schema work since the pragma is ignored inside a transaction
+    executeQuery("PRAGMA foreign_keys = ON;", {});
 }
 
 // Destructor
 Database::~Database() {
+    // finalize cached statements so the connection can close
+    Trace::Span span("sql finalize");
+    for (auto& entry : this->stmtCache) {
+        sqlite3_finalize(entry.second);
+    }
+    this->stmtCache.clear();
+    if (!this->readOnly) {
+        checkpoint();
+    }
     sqlite3_close(db);
 }
 
+// move wal pages back into the database file, how far depends on the profile
+void Database::checkpoint() {
+    int mode;
+    if (this->checkpointMode == "PASSIVE") {
+        mode = SQLITE_CHECKPOINT_PASSIVE; // only what can be done without waiting on readers
+    }
+    else if (this->checkpointMode == "FULL") {
+        mode = SQLITE_CHECKPOINT_FULL;
+    }
+    else if (this->checkpointMode == "TRUNCATE") {
+        mode = SQLITE_CHECKPOINT_TRUNCATE; // also empties the wal file
+    }
+    else {
+        return;
+    }
+    // no-op when the journal isn't a wal. runs from the destructor, so report instead of throwing
+    if (sqlite3_wal_checkpoint_v2(db, nullptr, mode, nullptr, nullptr) != SQLITE_OK) {
+        cerr << "Checkpoint failed: " << sqlite3_errmsg(db) << endl;
+    }
+}
+
 // Setup the DB Tables
 void Database::createTables() {
+    int version = getSchemaVersion();
+    if (version > SCHEMA_VERSION) {
+        throw runtime_error("Database was made by a newer version of this program (schema " + to_string(version) + ").");
+    }
+    if (version > 0 || tableExists("Tasks")) {
+        // existing database, version 0 tables are from before schema versioning
+        migrateSchema(version);
+        return;
+    }
+
+    // new database, create the current layout
+    Batch batch(*this);
     string sql;
 
     // Tables relationship info:
     // - A Board can have many Tasks (or none)
-    // - A Task belongs to one Board
+    // - A Task belongs to one Board, and is deleted with it
 
     // Create the Boards table
     sql = "CREATE TABLE IF NOT EXISTS Boards ("
@@ -37,24 +219,92 @@ void Database::createTables() {
     executeQuery(sql, {});
 
     // Create the Tasks table
-    sql = "CREATE TABLE IF NOT EXISTS Tasks ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "title TEXT NOT NULL,"
-        "description TEXT,"
-        "stage TEXT NOT NULL,"
-        "difficulty_rating INTEGER,"
-        "board_id INTEGER NOT NULL,"
-        "FOREIGN KEY(board_id) REFERENCES Boards(id)"
-        ");";
+    executeQuery(tasksTableSql("Tasks"), {});
+    executeQuery(TASKS_INDEX_SQL, {});
+    for (const string& sql : SEARCH_SCHEMA_SQL) {
+        runPragma(sql);
+    }
 
-    executeQuery(sql, {});
+    setSchemaVersion(SCHEMA_VERSION);
+    batch.commit();
+}
+
+// Upgrade tables made by an older version, one schema version at a time
+void Database::migrateSchema(int version) {
+    if (version < 1) {
+        // version 1: stage stored as its integer rank, tasks indexed in board order,
+        // tasks deleted with their board. sqlite can't change columns in place, so the
+        // table is rebuilt. foreign keys are still off here, so dropping the old table is safe
+        Batch batch(*this);
+        executeQuery(tasksTableSql("Tasks_new"), {});
+        // tasks of boards that no longer exist would break the foreign key, leave them behind
+        executeQuery("INSERT INTO Tasks_new(id, title, description, stage_rank, difficulty_rating, board_id) "
+            "SELECT id, title, description, "
+            "CASE stage WHEN 'To Do' THEN 0 WHEN 'In Progress' THEN 1 ELSE 2 END, "
+            "difficulty_rating, board_id FROM Tasks "
+            "WHERE board_id IN (SELECT id FROM Boards);", {});
+        // keep the id counter so ids of deleted tasks are not handed out again
+        executeQuery("DELETE FROM sqlite_sequence WHERE name = 'Tasks_new';", {});
+        executeQuery("UPDATE sqlite_sequence SET name = 'Tasks_new' WHERE name = 'Tasks';", {});
+        executeQuery("DROP TABLE Tasks;", {});
+        executeQuery("ALTER TABLE Tasks_new RENAME TO Tasks;", {});
+        executeQuery(TASKS_INDEX_SQL, {});
+        setSchemaVersion(1);
+        batch.commit();
+    }
+    if (version < 2) {
+        // version 2: full text search. existing tasks are indexed by the rebuild
+        Batch batch(*this);
+        for (const string& sql : SEARCH_SCHEMA_SQL) {
+            runPragma(sql);
+        }
+        runPragma("INSERT INTO TasksSearch(TasksSearch) VALUES ('rebuild');");
+        setSchemaVersion(2);
+        batch.commit();
+    }
+    if (version < 3) {
+        // version 3: the board order index also holds the rating
+        Batch batch(*this);
+        executeQuery("DROP INDEX IF EXISTS idx_tasks_board_order;", {});
+        executeQuery(TASKS_INDEX_SQL, {});
+        setSchemaVersion(3);
+        batch.commit();
+    }
+}
+
+// run a pragma that may return a row, which executeQuery doesn't expect
+void Database::runPragma(const string& sql) {
+    char* errorMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errorMsg) != SQLITE_OK) {
+        string error = errorMsg ? errorMsg : sqlite3_errmsg(db);
+        sqlite3_free(errorMsg);
+        throw runtime_error("Error applying " + sql + " " + error);
+    }
+}
+
+// schema version is kept in the database header
+int Database::getSchemaVersion() {
+    return queryInt("PRAGMA user_version;", {});
+}
+
+void Database::setSchemaVersion(int version) {
+    // pragmas can't take bound values
+    runPragma("PRAGMA user_version = " + to_string(version) + ";");
+}
+
+bool Database::tableExists(const string& tableName) {
+    return queryInt("SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = ?;",
+        { { "name", tableName } }) > 0;
 }
 
 // Clear the DB.
 void Database::deleteTables() {
     try {
-        executeQuery("DROP TABLE IF EXISTS Boards;", {});
+        // tasks first, they reference boards. the search triggers go with the Tasks table
+        executeQuery("DROP TABLE IF EXISTS TasksSearch;", {});
         executeQuery("DROP TABLE IF EXISTS Tasks;", {});
+        executeQuery("DROP TABLE IF EXISTS Boards;", {});
+        setSchemaVersion(0);
     }
     catch (const runtime_error& e) {
         cerr << "Caught exception: " << e.what() << endl;
@@ -63,13 +313,94 @@ void Database::deleteTables() {
 
 // helper method to safely execute sql queries
 int Database::executeQuery(const string& sql, const map<string, variant<int, string>>& dataMap) {
+    // the sql text itself is the shape of hand written queries
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    return runStatement(stmt, dataMap);
+}
+
+// look up a cached statement, ready for new bindings. returns nullptr on a miss
+sqlite3_stmt* Database::findStatement(const string& key) {
+    // every query starts here, its time runs until finishStatement
+    this->queryStart = chrono::steady_clock::now();
+    auto found = this->stmtCache.find(key);
+    if (found == this->stmtCache.end()) {
+        this->cacheMisses++;
+        return nullptr;
+    }
+    this->cacheHits++;
+    sqlite3_stmt* stmt = found->second;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return stmt;
+}
+
+// prepare a statement once and keep it for later calls with the same key
+sqlite3_stmt* Database::cacheStatement(const string& key, const string& sql) {
+    Trace::Span span("sql prepare", sql);
     sqlite3_stmt* stmt;
 
     // prepare the db action
     if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
         throw runtime_error("Error preparing query statement: " + string(sqlite3_errmsg(db)));
     }
+    this->stmtCache[key] = stmt;
+    return stmt;
+}
+
+// step a statement, one row or done
+int Database::step(sqlite3_stmt* stmt) {
+    Trace::Span span("sql step");
+    return sqlite3_step(stmt);
+}
 
+// reset a statement for reuse and count it in the session stats, rows read or changed.
+// while tracing, the whole query from lookup to reset is one span with its sql
+void Database::finishStatement(sqlite3_stmt* stmt, long long rows) {
+    sqlite3_reset(stmt);
+    auto finished = chrono::steady_clock::now();
+    long long micros = chrono::duration_cast<chrono::microseconds>(finished - this->queryStart).count();
+    Stats::addQuery(Stats::queryKind(sqlite3_sql(stmt)), micros, rows);
+    if (Trace::isEnabled()) {
+        Trace::complete("sql query", this->queryStart, finished, sqlite3_sql(stmt));
+    }
+}
+
+// run a query through the statement cache that returns a single number
+int Database::queryInt(const string& sql, const map<string, variant<int, string>>& dataMap) {
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    // bind values in map order, like runStatement
+    int index = 1;
+    for (const auto& param : dataMap) {
+        if (holds_alternative<int>(param.second)) {
+            sqlite3_bind_int(stmt, index, get<int>(param.second));
+        }
+        else {
+            sqlite3_bind_text(stmt, index, get<string>(param.second).c_str(), -1, SQLITE_STATIC);
+        }
+        index++;
+    }
+
+    int value = 0;
+    int resultCode = step(stmt);
+    if (resultCode == SQLITE_ROW) {
+        value = sqlite3_column_int(stmt, 0);
+    }
+    finishStatement(stmt, (resultCode == SQLITE_ROW) ? 1 : 0);
+    sqlite3_clear_bindings(stmt);
+    if (resultCode != SQLITE_ROW && resultCode != SQLITE_DONE) {
+        throw runtime_error("Failed to execute statement: " + string(sqlite3_errmsg(db)));
+    }
+    return value;
+}
+
+// bind values, step a cached statement and reset it for reuse
+int Database::runStatement(sqlite3_stmt* stmt, const map<string, variant<int, string>>& dataMap) {
     // bind values to sql datatype
     int index = 1;
     for (const auto& param : dataMap) {
@@ -89,15 +420,57 @@ int Database::executeQuery(const string& sql, const map<string, variant<int, str
         sqlite3_bind_int(stmt, index, get<int>(dataMap.at("id")));
     }
 
-    if (sqlite3_step(stmt) != SQLITE_DONE) {
+    int resultCode = step(stmt);
+    // reset before checking so the statement is reusable even after a failure
+    finishStatement(stmt, sqlite3_changes(db));
+    sqlite3_clear_bindings(stmt);
+    if (resultCode != SQLITE_DONE) {
         throw runtime_error("Failed to execute statement: " + string(sqlite3_errmsg(db)));
     }
-    sqlite3_finalize(stmt);
 
     // return record db id
     return static_cast<int>(sqlite3_last_insert_rowid(db));
 }
 
+// save a record through the statement cache, only building sql the first time a shape is seen
+int Database::saveRecord(const string& tableName, const map<string, variant<int, string>>& dataMap) {
+    string key = statementKey(tableName, dataMap);
+    sqlite3_stmt* stmt = findStatement(key);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(key, queryString(tableName, dataMap));
+    }
+    return runStatement(stmt, dataMap);
+}
+
+// insert a record with the id it already has, failing when that id is taken.
+// columns bind in map order with the id last, like the other generated queries
+void Database::insertRecord(const string& tableName, const map<string, variant<int, string>>& dataMap) {
+    string key = "INSERT ID " + statementKey(tableName, dataMap);
+    sqlite3_stmt* stmt = findStatement(key);
+    if (stmt == nullptr) {
+        string columns, placeholders;
+        for (const auto& column : dataMap) {
+            if (column.first != "id") {
+                columns += column.first + ", ";
+                placeholders += "?, ";
+            }
+        }
+        string sql = "INSERT INTO " + tableName + "(" + columns + "id) VALUES(" + placeholders + "?)";
+        stmt = cacheStatement(key, sql);
+    }
+    runStatement(stmt, dataMap);
+}
+
+// helper method to name the shape of a generated query: insert or update, table and columns
+string Database::statementKey(const string& tableName, const map<string, variant<int, string>>& dataMap) {
+    string key = (dataMap.count("id") > 0) ? "UPDATE " : "INSERT ";
+    key += tableName + ":";
+    for (const auto& column : dataMap) {
+        key += column.first + ",";
+    }
+    return key;
+}
+
 // helper method to construct the sql query string
 string Database::queryString(const string& tableName, const map<string, variant<int, string>>& dataMap) {
     bool hasId = (dataMap.count("id") > 0);
@@ -142,9 +515,8 @@ void Database::saveBoardData(Board& board) {
         dataMap.insert({ "id", board.getId() });
     }
 
-    // create sql statement and execute
-    string sql = queryString(tableName, dataMap);
-    int returnId = executeQuery(sql, dataMap);
+    // execute with the cached statement for this shape
+    int returnId = saveRecord(tableName, dataMap);
 
     // If new record, fetch the created db id
     if (isNew) {
@@ -154,13 +526,7 @@ void Database::saveBoardData(Board& board) {
 
 void Database::saveTaskData(Task& task) {
     string tableName = "Tasks";
-    map<string, variant<int, string>> dataMap = {
-        { "title", variant<int, string>{task.getTitle()} },
-        { "description", variant<int, string>{task.getDescription()} },
-        { "difficulty_rating", variant<int, string>{task.getDifficulty()} },
-        { "stage", variant<int, string>{task.stageToString(task.getStage())} },
-        { "board_id", variant<int, string>{task.getBoardId()} }
-    };
+    map<string, variant<int, string>> dataMap = taskRecord(task);
 
     // include id only if not new
     bool isNew = (task.getId() == 0);
@@ -168,9 +534,8 @@ void Database::saveTaskData(Task& task) {
         dataMap.insert({ "id", task.getId() });
     }
 
-    // create sql statement and execute
-    string sql = queryString(tableName, dataMap);
-    int returnId = executeQuery(sql, dataMap);
+    // execute with the cached statement for this shape
+    int returnId = saveRecord(tableName, dataMap);
 
     // If new record, fetch the created db id
     if (isNew) {
@@ -178,25 +543,126 @@ void Database::saveTaskData(Task& task) {
     }
 }
 
-// Delete Board
-void Database::deleteBoard(Board& board) {
-    // Delete all tasks associated with board
-    string sqlTasks = "DELETE FROM Tasks WHERE board_id = ?";
+// add a board under the id it already has
+void Database::insertBoard(Board& board) {
+    insertRecord("Boards", { { "title", board.getTitle() }, { "id", board.getId() } });
+}
 
-    map<string, variant<int, string>> dataMapTasks = {
-        { "board_id", variant<int, string>{board.getId()} }
-    };
+// add a task under the id it already has
+void Database::insertTask(Task& task) {
+    map<string, variant<int, string>> dataMap = taskRecord(task);
+    dataMap.insert({ "id", task.getId() });
+    insertRecord("Tasks", dataMap);
+}
 
-    executeQuery(sqlTasks, dataMapTasks);
+// first id not used yet in a table, ids of deleted rows are not given out again
+int Database::nextId(const string& tableName) {
+    return queryInt("SELECT MAX(COALESCE((SELECT seq FROM sqlite_sequence WHERE name = ?), 0), "
+        "COALESCE((SELECT MAX(id) FROM " + tableName + "), 0)) + 1;", { { "name", tableName } });
+}
+
+// save many tasks in a single transaction. nothing is kept if any task fails
+void Database::saveTasks(vector<Task>& tasks) {
+    // check every row first so a bad task stops the batch before any write
+    for (Task& task : tasks) {
+        task.validate();
+    }
+
+    Batch batch(*this);
+    list<Task*> inserted;
+    try {
+        for (Task& task : tasks) {
+            bool isNew = (task.getId() == 0);
+            saveTaskData(task);
+            if (isNew) {
+                inserted.push_back(&task);
+            }
+        }
+        batch.commit();
+    }
+    catch (...) {
+        // rows are rolled back, so new tasks lose their ids again
+        for (Task* task : inserted) {
+            task->setId(0);
+        }
+        throw;
+    }
+}
 
-    // Delete the board
-    string sqlBoard = "DELETE FROM Boards WHERE id = ?";
+// add many new tasks in a single transaction, binding each row straight into one reused
+// insert instead of building a record map per task. gives each task its id
+void Database::insertTasks(vector<Task>& tasks) {
+    for (Task& task : tasks) {
+        task.validate();
+    }
 
-    map<string, variant<int, string>> dataMapBoards = {
+    string sql = "INSERT INTO Tasks (title, description, stage_rank, difficulty_rating, board_id) VALUES (?, ?, ?, ?, ?);";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    Batch batch(*this);
+    size_t inserted = 0;
+    try {
+        for (Task& task : tasks) {
+            this->queryStart = chrono::steady_clock::now(); // each row is timed as its own query
+            sqlite3_bind_text(stmt, 1, task.getTitle().data(), static_cast<int>(task.getTitle().size()), SQLITE_STATIC);
+            sqlite3_bind_text(stmt, 2, task.getDescription().data(), static_cast<int>(task.getDescription().size()), SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 3, static_cast<int>(task.getStage()));
+            sqlite3_bind_int(stmt, 4, task.getDifficulty());
+            sqlite3_bind_int(stmt, 5, task.getBoardId());
+            int resultCode = step(stmt);
+            finishStatement(stmt, 1);
+            if (resultCode != SQLITE_DONE) {
+                throw runtime_error("Failed to execute statement: " + string(sqlite3_errmsg(db)));
+            }
+            task.setId(static_cast<int>(sqlite3_last_insert_rowid(db)));
+            inserted++;
+        }
+        sqlite3_clear_bindings(stmt);
+        batch.commit();
+    }
+    catch (...) {
+        // rows are rolled back, so the tasks lose their ids again
+        sqlite3_clear_bindings(stmt);
+        for (size_t i = 0; i < inserted; i++) {
+            tasks[i].setId(0);
+        }
+        throw;
+    }
+}
+
+// drop the board order index and the search triggers, so a bulk load only writes the table.
+// run inside the batch that loads the tasks and calls rebuildTaskIndexes, a load that fails
+// then rolls the indexes back too
+void Database::dropTaskIndexes() {
+    executeQuery("DROP INDEX IF EXISTS idx_tasks_board_order;", {});
+    executeQuery("DROP TRIGGER IF EXISTS TasksSearchInsert;", {});
+    executeQuery("DROP TRIGGER IF EXISTS TasksSearchDelete;", {});
+    executeQuery("DROP TRIGGER IF EXISTS TasksSearchUpdate;", {});
+}
+
+// build the indexes dropped by dropTaskIndexes in one pass each over the whole table
+void Database::rebuildTaskIndexes() {
+    executeQuery(TASKS_INDEX_SQL, {});
+    // the first entry makes the search table, which was kept
+    for (size_t i = 1; i < SEARCH_SCHEMA_SQL.size(); i++) {
+        runPragma(SEARCH_SCHEMA_SQL[i]);
+    }
+    runPragma("INSERT INTO TasksSearch(TasksSearch) VALUES ('rebuild');");
+}
+
+// Delete Board
+void Database::deleteBoard(Board& board) {
+    // tasks of the board are removed with it by the ON DELETE CASCADE foreign key,
+    // in the same statement, so they go together or not at all
+    string sql = "DELETE FROM Boards WHERE id = ?";
+
+    map<string, variant<int, string>> dataMap = {
         { "id", variant<int, string>{board.getId()} }
     };
 
-    executeQuery(sqlBoard, dataMapBoards);
+    executeQuery(sql, dataMap);
 }
 
 // Delete Task
@@ -210,83 +676,486 @@ void Database::deleteTask(Task& task) {
     executeQuery(sql, dataMap);
 }
 
-// Load Boards
-list<Board*> Database::loadBoardsList() {
-    list<Board*> boards;
-    string sql = "SELECT * FROM Boards ORDER BY title, id;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        throw runtime_error("Error preparing load board statement: " + string(sqlite3_errmsg(db)));
+// Load Boards, with the task count of each stage and the total rating of their tasks.
+// one grouped scan of the covering board order index, however many boards there are
+vector<Board*> Database::loadBoardsList() {
+    vector<Board*> boards;
+    string sql = "SELECT Boards.id, Boards.title, summary.stage_rank, summary.tasks, summary.difficulty FROM Boards "
+        "LEFT JOIN (SELECT board_id, stage_rank, COUNT(*) AS tasks, TOTAL(difficulty_rating) AS difficulty "
+        "FROM Tasks GROUP BY board_id, stage_rank) AS summary ON summary.board_id = Boards.id "
+        "ORDER BY Boards.title, Boards.id;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
     }
 
-    map<string, int> columnIndices;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        // map column names to know where which column to get data from
-        if (columnIndices.empty()) {
-            int columnCount = sqlite3_column_count(stmt);
-            for (int i = 0; i < columnCount; i++) {
-                columnIndices[string(sqlite3_column_name(stmt, i))] = i;
+    // one row per stage that has tasks, a board without tasks has a single row of nulls
+    Board* board = nullptr;
+    int counts[3] = { 0, 0, 0 };
+    double difficulty = 0;
+    long long rows = 0;
+    int resultCode;
+    while ((resultCode = step(stmt)) == SQLITE_ROW) {
+        rows++;
+        int id = sqlite3_column_int(stmt, 0);
+        if (board == nullptr || board->getId() != id) {
+            if (board != nullptr) {
+                board->setStageCounts(counts[0], counts[1], counts[2]);
+                board->setTotalDifficulty(static_cast<int>(difficulty));
             }
+            // create board object, save fetched info
+            string title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            board = new Board(title);
+            board->setId(id);
+            boards.push_back(board);
+            counts[0] = counts[1] = counts[2] = 0;
+            difficulty = 0;
         }
-        // Get values using columnIndices map
-        int id = sqlite3_column_int(stmt, columnIndices["id"]);
-        string title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, columnIndices["title"]));
-
-        // create board object, save fetched info
-        Board* board = new Board(title);
-        board->setId(id);
-        boards.push_back(board);
+        if (sqlite3_column_type(stmt, 2) != SQLITE_NULL) {
+            counts[sqlite3_column_int(stmt, 2)] = sqlite3_column_int(stmt, 3);
+            difficulty += sqlite3_column_double(stmt, 4);
+        }
+    }
+    if (board != nullptr) {
+        board->setStageCounts(counts[0], counts[1], counts[2]);
+        board->setTotalDifficulty(static_cast<int>(difficulty));
     }
 
-    sqlite3_finalize(stmt);
+    finishStatement(stmt, rows); // keep cached statement for next load
+    if (resultCode != SQLITE_DONE) {
+        // an interrupted or failed scan would look like a shorter list
+        for (Board* loaded : boards) {
+            delete loaded;
+        }
+        throw runtime_error("Failed to load boards: " + string(sqlite3_errmsg(db)));
+    }
     return boards;
 }
 
 // Load Tasks
-list<Task*> Database::loadTaskData(Board& board) {
-    list<Task*> tasks;
+vector<Task> Database::loadTaskData(Board& board) {
     string sql = "SELECT * FROM Tasks WHERE board_id = ? "
-        "ORDER BY CASE "
-        "WHEN stage = 'To Do' THEN 1 "
-        "WHEN stage = 'In Progress' THEN 2 "
-        "WHEN stage = 'Done' THEN 3 "
-        "END, id;";
-    sqlite3_stmt* stmt;
-
-    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
-        throw runtime_error("Error preparing load task statement: " + string(sqlite3_errmsg(db)));
+        "ORDER BY stage_rank, id;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
     }
     // Bind ? to board id
     sqlite3_bind_int(stmt, 1, board.getId());
 
-    map<string, int> columnIndices;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        // map column names to know where which column to get data from
-        if (columnIndices.empty()) {
-            int columnCount = sqlite3_column_count(stmt);
-            for (int i = 0; i < columnCount; i++) {
-                columnIndices[string(sqlite3_column_name(stmt, i))] = i;
+    return readTasks(stmt, board);
+}
+
+// Load a page of tasks that come after the (stage rank, id) key, in board order
+vector<Task> Database::loadTaskPage(Board& board, int afterRank, int afterId, int limit) {
+    // keyset pagination: seek the board order index past the last loaded key instead of using OFFSET.
+    // sqlite only seeks the index on the first column of a (stage_rank, id) row value,
+    // so the rest of the key's stage and the later stages are read as two seeks
+    string sql = "SELECT * FROM ("
+        "SELECT * FROM Tasks WHERE board_id = ?1 AND stage_rank = ?2 AND id > ?3 ORDER BY id LIMIT ?4"
+        ") UNION ALL SELECT * FROM ("
+        "SELECT * FROM Tasks WHERE board_id = ?1 AND stage_rank > ?2 ORDER BY stage_rank, id LIMIT ?4"
+        ") ORDER BY stage_rank, id LIMIT ?4;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    sqlite3_bind_int(stmt, 1, board.getId());
+    sqlite3_bind_int(stmt, 2, afterRank);
+    sqlite3_bind_int(stmt, 3, afterId);
+    sqlite3_bind_int(stmt, 4, limit);
+
+    return readTasks(stmt, board);
+}
+
+// Load a page of tasks that come before the (stage rank, id) key, in board order
+vector<Task> Database::loadTaskPageBefore(Board& board, int beforeRank, int beforeId, int limit) {
+    // walk backwards from the key, then flip the page back into board order
+    string sql = "SELECT * FROM ("
+        "SELECT * FROM Tasks WHERE board_id = ?1 AND stage_rank = ?2 AND id < ?3 ORDER BY id DESC LIMIT ?4"
+        ") UNION ALL SELECT * FROM ("
+        "SELECT * FROM Tasks WHERE board_id = ?1 AND stage_rank < ?2 ORDER BY stage_rank DESC, id DESC LIMIT ?4"
+        ") ORDER BY stage_rank DESC, id DESC LIMIT ?4;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    sqlite3_bind_int(stmt, 1, board.getId());
+    sqlite3_bind_int(stmt, 2, beforeRank);
+    sqlite3_bind_int(stmt, 3, beforeId);
+    sqlite3_bind_int(stmt, 4, limit);
+
+    vector<Task> tasks = readTasks(stmt, board);
+    reverse(tasks.begin(), tasks.end());
+    return tasks;
+}
+
+// Load the number of tasks in each stage of a board and the total of their ratings
+void Database::loadStageCounts(Board& board) {
+    // counted from the board order index alone
+    string sql = "SELECT stage_rank, COUNT(*), TOTAL(difficulty_rating) FROM Tasks WHERE board_id = ? GROUP BY stage_rank;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    sqlite3_bind_int(stmt, 1, board.getId());
+
+    int counts[3] = { 0, 0, 0 };
+    double difficulty = 0;
+    long long rows = 0;
+    int resultCode;
+    while ((resultCode = step(stmt)) == SQLITE_ROW) {
+        counts[sqlite3_column_int(stmt, 0)] = sqlite3_column_int(stmt, 1);
+        difficulty += sqlite3_column_double(stmt, 2);
+        rows++;
+    }
+    finishStatement(stmt, rows);
+    if (resultCode != SQLITE_DONE) {
+        throw runtime_error("Failed to count tasks: " + string(sqlite3_errmsg(db)));
+    }
+    board.setStageCounts(counts[0], counts[1], counts[2]);
+    board.setTotalDifficulty(static_cast<int>(difficulty));
+}
+
+// Count the tasks placed before a task on its board, ie the task's board position.
+// tasks in leaveOut aren't counted, the caller places those itself
+int Database::countTasksBefore(Board& board, Task& task, const vector<int>& leaveOut) {
+    string skip;
+    for (int id : leaveOut) {
+        skip += (skip.empty() ? " AND id NOT IN (" : ", ") + to_string(id);
+    }
+    if (!skip.empty()) {
+        skip += ")";
+    }
+    string sql = "SELECT "
+        "(SELECT COUNT(*) FROM Tasks WHERE board_id = ?1 AND stage_rank < ?2" + skip + ") + "
+        "(SELECT COUNT(*) FROM Tasks WHERE board_id = ?1 AND stage_rank = ?2 AND id < ?3" + skip + ");";
+    // the id list changes with every edit, so only the plain count is worth caching
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr && skip.empty()) {
+        stmt = cacheStatement(sql, sql);
+    }
+    else if (stmt == nullptr && sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        throw runtime_error("Error preparing query statement: " + string(sqlite3_errmsg(db)));
+    }
+    sqlite3_bind_int(stmt, 1, board.getId());
+    sqlite3_bind_int(stmt, 2, static_cast<int>(task.getStage()));
+    sqlite3_bind_int(stmt, 3, task.getId());
+
+    int count = 0;
+    int resultCode = step(stmt);
+    if (resultCode == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    }
+    finishStatement(stmt, 1);
+    string error = sqlite3_errmsg(db);
+    if (!skip.empty()) {
+        sqlite3_finalize(stmt);
+    }
+    if (resultCode != SQLITE_ROW) {
+        throw runtime_error("Failed to count tasks: " + error);
+    }
+    return count;
+}
+
+// Load one task of a board by id, empty if it isn't on the board
+vector<Task> Database::loadTask(Board& board, int taskId) {
+    string sql = "SELECT * FROM Tasks WHERE id = ? AND board_id = ?;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    sqlite3_bind_int(stmt, 1, taskId);
+    sqlite3_bind_int(stmt, 2, board.getId());
+
+    return readTasks(stmt, board);
+}
+
+// board a task belongs to, 0 if there is no such task
+int Database::findTaskBoardId(int taskId) {
+    return queryInt("SELECT board_id FROM Tasks WHERE id = ?;", { { "id", taskId } });
+}
+
+// Visit every task with its board's title in id order, returns the number visited
+long long Database::forEachTask(const function<void(const TaskRow&)>& visit) {
+    // one forward cursor over the table, rows are handed over straight from sqlite
+    // so nothing builds up however many tasks there are
+    string sql = "SELECT Tasks.id, Tasks.board_id, Boards.title, Tasks.title, Tasks.description, "
+        "Tasks.stage_rank, Tasks.difficulty_rating FROM Tasks JOIN Boards ON Boards.id = Tasks.board_id ORDER BY Tasks.id;";
+    sqlite3_stmt* stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+
+    Trace::Span span("sql scan");
+    long long rows = 0;
+    int result;
+    try {
+        // stepped directly, a span per row would fill the trace
+        while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+            TaskRow row;
+            row.id = sqlite3_column_int(stmt, 0);
+            row.boardId = sqlite3_column_int(stmt, 1);
+            row.boardTitle = columnText(stmt, 2);
+            row.title = columnText(stmt, 3);
+            row.description = columnText(stmt, 4);
+            row.stage = static_cast<Stage>(sqlite3_column_int(stmt, 5));
+            row.difficulty = sqlite3_column_int(stmt, 6);
+            visit(row);
+            rows++;
+        }
+    }
+    catch (...) {
+        finishStatement(stmt, rows);
+        throw;
+    }
+    finishStatement(stmt, rows);
+    if (result != SQLITE_DONE) {
+        // a cut short scan would look like a complete one
+        throw runtime_error("Failed to read tasks: " + string(sqlite3_errmsg(db)));
+    }
+    return rows;
+}
+
+// Search titles and descriptions of all tasks, best matches first
+vector<Database::SearchHit> Database::searchTasks(const string& text, int limit) {
+    vector<SearchHit> hits;
+    string query = searchQuery(text);
+    if (query.empty()) {
+        return hits;
+    }
+
+    // a word still being typed matches as a prefix. past the prefix index length fts5 merges the
+    // lists of every word with that prefix, so first look for it by its indexed prefix and check the
+    // rest of the word on the few rows that are ranked
+    string indexedQuery = searchQuery(text, SEARCH_PREFIX_LENGTH);
+    if (indexedQuery != query) {
+        size_t wordStart = text.size();
+        while (wordStart > 0 && (isalnum(static_cast<unsigned char>(text[wordStart - 1])) || static_cast<unsigned char>(text[wordStart - 1]) >= 0x80)) {
+            wordStart--;
+        }
+        if (rankMatches(indexedQuery, text.substr(wordStart), limit, hits) || hits.size() >= static_cast<size_t>(limit)) {
+            return hits;
+        }
+        // few of the newest matches start with the whole word, so its own lists are short
+        hits.clear();
+    }
+    rankMatches(query, "", limit, hits);
+    return hits;
+}
+
+// rank the newest SEARCH_RANK_WINDOW matches of an fts5 query, true when that was all of them.
+// the index walks matches in id order and stops at the window, ranking every match of a common
+// word would read its whole list
+bool Database::rankMatches(const string& query, const string& typed, int limit, vector<SearchHit>& hits) {
+    string windowSql = "SELECT rowid FROM TasksSearch WHERE TasksSearch MATCH ? ORDER BY rowid DESC LIMIT 1 OFFSET ?;";
+    sqlite3_stmt* stmt = findStatement(windowSql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(windowSql, windowSql);
+    }
+    sqlite3_bind_text(stmt, 1, query.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, SEARCH_RANK_WINDOW - 1);
+    int firstId = 0; // all matches are ranked when there are fewer than the window
+    int windowCode = step(stmt);
+    if (windowCode == SQLITE_ROW) {
+        firstId = sqlite3_column_int(stmt, 0);
+    }
+    finishStatement(stmt, (firstId != 0) ? 1 : 0);
+    if (windowCode != SQLITE_ROW && windowCode != SQLITE_DONE) {
+        throw runtime_error("Search failed: " + string(sqlite3_errmsg(db)));
+    }
+
+    // score the matches in the index first, then read only the rows that are shown
+    string sql = "WITH matches AS MATERIALIZED ("
+        "SELECT rowid AS id, search_score(TasksSearch, ?) AS score FROM TasksSearch WHERE TasksSearch MATCH ? AND rowid >= ?"
+        ") SELECT Tasks.id, Tasks.board_id, Tasks.title FROM matches JOIN Tasks ON Tasks.id = matches.id "
+        "WHERE matches.score IS NOT NULL ORDER BY matches.score DESC, matches.id DESC LIMIT ?;";
+    stmt = findStatement(sql);
+    if (stmt == nullptr) {
+        stmt = cacheStatement(sql, sql);
+    }
+    sqlite3_bind_text(stmt, 1, typed.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, query.c_str(), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, firstId);
+    sqlite3_bind_int(stmt, 4, limit);
+
+    int resultCode;
+    size_t hitsBefore = hits.size();
+    while ((resultCode = step(stmt)) == SQLITE_ROW) {
+        const char* title = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+        hits.push_back({ sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1), title ? title : "" });
+    }
+    finishStatement(stmt, static_cast<long long>(hits.size() - hitsBefore));
+    if (resultCode != SQLITE_DONE) {
+        throw runtime_error("Search failed: " + string(sqlite3_errmsg(db)));
+    }
+    return firstId == 0;
+}
+
+// turn typed text into an fts5 query: every word must match. the word still being typed matches
+// as the start of a word, cut to prefixLength characters. finished words match whole, which keeps
+// common words cheap
+string Database::searchQuery(const string& text, size_t prefixLength) {
+    string query;
+    string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        unsigned char c = (i < text.size()) ? text[i] : ' ';
+        // letters, digits and any utf-8 byte make up words, everything else splits them
+        if (isalnum(c) || c >= 0x80) {
+            word += static_cast<char>(c);
+        }
+        else if (!word.empty()) {
+            // count characters, utf-8 continuation bytes belong to the character before them
+            size_t characters = 0;
+            size_t cut = 0;
+            for (; cut < word.size(); cut++) {
+                if ((word[cut] & 0xC0) != 0x80 && ++characters > prefixLength) {
+                    break;
+                }
             }
+            // quoted so words like AND or NOT aren't read as operators. single letters have
+            // no prefix index and would expand to half the vocabulary, they match whole words
+            bool typing = (i == text.size()) && word.size() > 1;
+            if (typing) {
+                word.resize(cut);
+            }
+            query += (query.empty() ? "\"" : " \"") + word + (typing ? "\"*" : "\"");
+            word.clear();
         }
-        // Get values using columnIndices map
-        int id = sqlite3_column_int(stmt, columnIndices["id"]);
-        const char* titleRaw = reinterpret_cast<const char*>(sqlite3_column_text(stmt, columnIndices["title"]));
+    }
+    return query;
+}
+
+// columns of a task row, without the id
+map<string, variant<int, string>> Database::taskRecord(Task& task) {
+    return {
+        { "title", variant<int, string>{task.getTitle()} },
+        { "description", variant<int, string>{task.getDescription()} },
+        { "difficulty_rating", variant<int, string>{task.getDifficulty()} },
+        { "stage_rank", variant<int, string>{static_cast<int>(task.getStage())} },
+        { "board_id", variant<int, string>{task.getBoardId()} }
+    };
+}
+
+// a text column without copying it, null reads as empty
+string_view Database::columnText(sqlite3_stmt* stmt, int column) {
+    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
+    return text ? string_view(text, sqlite3_column_bytes(stmt, column)) : string_view();
+}
+
+// helper method to read task rows from a bound task query
+vector<Task> Database::readTasks(sqlite3_stmt* stmt, Board& board) {
+    vector<Task> tasks;
+
+    // map column names to know where which column to get data from
+    map<string, int> columnIndices;
+    int columnCount = sqlite3_column_count(stmt);
+    for (int i = 0; i < columnCount; i++) {
+        columnIndices[string(sqlite3_column_name(stmt, i))] = i;
+    }
+    // look up each column once instead of once per row
+    int idColumn = columnIndices["id"];
+    int titleColumn = columnIndices["title"];
+    int descriptionColumn = columnIndices["description"];
+    int stageColumn = columnIndices["stage_rank"];
+    int difficultyColumn = columnIndices["difficulty_rating"];
+
+    int resultCode;
+    while ((resultCode = step(stmt)) == SQLITE_ROW) {
+        // Get values using the column positions
+        int id = sqlite3_column_int(stmt, idColumn);
+        const char* titleRaw = reinterpret_cast<const char*>(sqlite3_column_text(stmt, titleColumn));
         string title = titleRaw ? titleRaw : "";
-        const char* descriptionRaw = reinterpret_cast<const char*>(sqlite3_column_text(stmt, columnIndices["description"]));
+        const char* descriptionRaw = reinterpret_cast<const char*>(sqlite3_column_text(stmt, descriptionColumn));
         string description = descriptionRaw ? descriptionRaw : "";
-        string stageStr = reinterpret_cast<const char*>(sqlite3_column_text(stmt, columnIndices["stage"]));
-        int difficultyRating = sqlite3_column_int(stmt, columnIndices["difficulty_rating"]);
+        Stage stage = static_cast<Stage>(sqlite3_column_int(stmt, stageColumn));
+        int difficultyRating = sqlite3_column_int(stmt, difficultyColumn);
 
-        // create task object, save fetched info
-        Task* task = new Task(title, board);
-        task->setId(id);
-        task->setDescription(description);
-        task->setDifficulty(difficultyRating);
-        task->setStage(task->stringToStage(stageStr), true);
-        tasks.push_back(task);
+        // create task in place, save fetched info
+        tasks.emplace_back(move(title), board);
+        Task& task = tasks.back();
+        task.setId(id);
+        task.setDescription(move(description));
+        task.setDifficulty(difficultyRating);
+        task.setStage(stage, true);
     }
 
-    sqlite3_finalize(stmt);
+    finishStatement(stmt, static_cast<long long>(tasks.size())); // keep cached statement for next load
+    if (resultCode != SQLITE_DONE) {
+        // an interrupted or failed query would look like a short page
+        throw runtime_error("Failed to load tasks: " + string(sqlite3_errmsg(db)));
+    }
     return tasks;
 }
+
+// stop the query running on this connection, it fails with SQLITE_INTERRUPT.
+// the one call that is safe from another thread
+void Database::interrupt() {
+    sqlite3_interrupt(db);
+}
+
+// statement cache counters
+long long Database::getCacheHits() {
+    return this->cacheHits;
+}
+
+long long Database::getCacheMisses() {
+    return this->cacheMisses;
+}
+
+bool Database::isReadOnly() {
+    return this->readOnly;
+}
+
+// Batch transaction
+Database::Batch::Batch(Database& database) : database(database) {
+    this->committed = false;
+    // only the outermost batch begins and ends the transaction
+    this->ownsTransaction = (sqlite3_get_autocommit(database.db) != 0);
+    if (this->ownsTransaction) {
+        database.executeQuery("BEGIN IMMEDIATE;", {});
+    }
+}
+
+Database::Batch::~Batch() {
+    if (this->ownsTransaction && !this->committed) {
+        try {
+            this->database.executeQuery("ROLLBACK;", {});
+        }
+        catch (const runtime_error& e) {
+            cerr << "Caught exception: " << e.what() << endl;
+        }
+    }
+}
+
+void Database::Batch::commit() {
+    if (this->ownsTransaction && !this->committed) {
+        this->database.executeQuery("COMMIT;", {});
+    }
+    this->committed = true;
+}
+
+Database::Savepoint::Savepoint(Database& database) : database(database) {
+    this->released = false;
+    database.executeQuery("SAVEPOINT part;", {});
+}
+
+Database::Savepoint::~Savepoint() {
+    if (!this->released) {
+        // undo only what ran since the savepoint, then drop it
+        try {
+            this->database.executeQuery("ROLLBACK TO part;", {});
+            this->database.executeQuery("RELEASE part;", {});
+        }
+        catch (const runtime_error& e) {
+            cerr << "Caught exception: " << e.what() << endl;
+        }
+    }
+}
+
+void Database::Savepoint::release() {
+    if (!this->released) {
+        this->database.executeQuery("RELEASE part;", {});
+    }
+    this->released = true;
+}
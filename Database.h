@@ -3,6 +3,9 @@
 
 #include "Board.h"
 #include "Task.h"
+#include "DbProfile.h"
+#include "Stats.h"
+#include "Trace.h"
 #include <sqlite3.h>
 #include <stdexcept>
 #include <iostream>
@@ -10,7 +13,13 @@
 #include <variant>
 #include <string>
 #include <list>
+#include <vector>
 #include <map>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <functional>
+#include <string_view>
 
 using namespace std;
 
@@ -19,22 +28,119 @@ class Task;
 
 class Database {
 public:
-    Database(string dbName);
+    // groups writes into one transaction, rolled back unless committed
+    class Batch {
+    public:
+        Batch(Database& database);
+        ~Batch();
+        void commit();
+
+    private:
+        Database& database;
+        bool ownsTransaction; // false when nested inside another batch
+        bool committed;
+    };
+
+    // a part of a transaction that can be undone alone, rolled back to unless released
+    class Savepoint {
+    public:
+        Savepoint(Database& database);
+        ~Savepoint();
+        void release();
+
+    private:
+        Database& database;
+        bool released;
+    };
+
+    // a task found by search, with what the results list shows
+    struct SearchHit {
+        int taskId;
+        int boardId;
+        string title;
+    };
+
+    // one task as exported, the text points into sqlite's row and is only valid during the visit
+    struct TaskRow {
+        int id;
+        int boardId;
+        string_view boardTitle;
+        string_view title;
+        string_view description;
+        Stage stage;
+        int difficulty;
+    };
+
+    static const int SCHEMA_VERSION = 3; // stored in PRAGMA user_version, 0 is the unversioned layout
+    static const int SEARCH_RANK_WINDOW = 200; // newest matches ranked by a search
+    static const size_t SEARCH_PREFIX_LENGTH = 3; // longest prefix in the search index
+
+    Database(string dbName, DbProfile profile = DbProfile(), bool readOnly = false);
     ~Database();
+    // owns the sqlite handle and cached statements, so copies are not allowed
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+    void checkpoint();
     void createTables();
+    void migrateSchema(int version);
+    int getSchemaVersion();
     void deleteTables();
     int executeQuery(const string& sql, const map<string, variant<int, string>>& dataMap);
     string queryString(const string& tableName, const map<string, variant<int, string>>& dataMap);
+    string statementKey(const string& tableName, const map<string, variant<int, string>>& dataMap);
     void saveBoardData(Board& board);
     void saveTaskData(Task& task);
+    void saveTasks(vector<Task>& tasks);
+    void insertTasks(vector<Task>& tasks);
+    void dropTaskIndexes();
+    void rebuildTaskIndexes();
+    void insertBoard(Board& board);
+    void insertTask(Task& task);
+    int nextId(const string& tableName);
     void deleteBoard(Board& board);
     void deleteTask(Task& task);
-    list<Board*> loadBoardsList();
-    list<Task*> loadTaskData(Board& board);
+    vector<Board*> loadBoardsList();
+    vector<Task> loadTaskData(Board& board);
+    vector<Task> loadTaskPage(Board& board, int afterRank, int afterId, int limit);
+    vector<Task> loadTaskPageBefore(Board& board, int beforeRank, int beforeId, int limit);
+    void loadStageCounts(Board& board);
+    int countTasksBefore(Board& board, Task& task, const vector<int>& leaveOut = {});
+    vector<Task> loadTask(Board& board, int taskId);
+    int findTaskBoardId(int taskId);
+    long long forEachTask(const function<void(const TaskRow&)>& visit);
+    vector<SearchHit> searchTasks(const string& text, int limit);
+    static string searchQuery(const string& text, size_t prefixLength = string::npos);
+    void interrupt();
+    long long getCacheHits();
+    long long getCacheMisses();
+    bool isReadOnly();
 
 private:
+    sqlite3_stmt* findStatement(const string& key);
+    sqlite3_stmt* cacheStatement(const string& key, const string& sql);
+    int step(sqlite3_stmt* stmt);
+    void finishStatement(sqlite3_stmt* stmt, long long rows);
+    void runPragma(const string& sql);
+    void setSchemaVersion(int version);
+    bool tableExists(const string& tableName);
+    int queryInt(const string& sql, const map<string, variant<int, string>>& dataMap);
+    bool rankMatches(const string& query, const string& typed, int limit, vector<SearchHit>& hits);
+    int runStatement(sqlite3_stmt* stmt, const map<string, variant<int, string>>& dataMap);
+    vector<Task> readTasks(sqlite3_stmt* stmt, Board& board);
+    static string_view columnText(sqlite3_stmt* stmt, int column);
+    int saveRecord(const string& tableName, const map<string, variant<int, string>>& dataMap);
+    void insertRecord(const string& tableName, const map<string, variant<int, string>>& dataMap);
+    static map<string, variant<int, string>> taskRecord(Task& task);
+
     string dbName;
     sqlite3* db;
+    string checkpointMode; // wal checkpoint run on close
+    bool readOnly; // opened for reading only, the schema is left to the writer
+    // prepared statements reused between calls, keyed by statement shape
+    map<string, sqlite3_stmt*> stmtCache;
+    long long cacheHits;
+    long long cacheMisses;
+    chrono::steady_clock::time_point queryStart; // when the running statement was looked up
 };
 
 #endif // DATABASE_H
@@ -0,0 +1,154 @@
+#include "DbProfile.h"
+
+using namespace std;
+
+DbProfile::DbProfile() {
+    // same as the safe preset
+    this->name = "safe";
+    this->journalMode = "WAL";
+    this->synchronous = "FULL";
+    this->mmapSize = 0;
+    this->cacheSize = -8000;
+    this->tempStore = "DEFAULT";
+    this->busyTimeout = 5000;
+    this->checkpoint = "TRUNCATE";
+}
+
+// every commit waits for the disk, the wal is folded back and emptied on exit
+DbProfile DbProfile::safe() {
+    return DbProfile();
+}
+
+// commits survive a crash of the app but the last ones can be lost on power failure,
+// reads go through mmap and a bigger cache
+DbProfile DbProfile::fast() {
+    DbProfile profile;
+    profile.name = "fast";
+    profile.synchronous = "NORMAL";
+    profile.mmapSize = 256LL * 1024 * 1024;
+    profile.cacheSize = -64000;
+    profile.tempStore = "MEMORY";
+    profile.checkpoint = "PASSIVE";
+    return profile;
+}
+
+DbProfile DbProfile::named(const string& name) {
+    if (name == "safe") {
+        return safe();
+    }
+    else if (name == "fast") {
+        return fast();
+    }
+    throw invalid_argument("Unknown database profile '" + name + "'. Use safe or fast.");
+}
+
+// read "key = value" lines, # starts a comment. returns false if the file isn't there
+bool DbProfile::loadFile(const string& path) {
+    ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    string line;
+    int lineNumber = 0;
+    while (getline(file, line)) {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        size_t equals = line.find('=');
+        if (line.find_first_not_of(" \t\r") == string::npos) {
+            continue;
+        }
+        if (equals == string::npos) {
+            throw invalid_argument(path + " line " + to_string(lineNumber) + ": expected key = value.");
+        }
+        // trim spaces around key and value
+        string key = line.substr(0, equals);
+        string value = line.substr(equals + 1);
+        key = key.substr(key.find_first_not_of(" \t"));
+        key = key.substr(0, key.find_last_not_of(" \t") + 1);
+        size_t valueStart = value.find_first_not_of(" \t\r");
+        value = (valueStart == string::npos) ? "" : value.substr(valueStart);
+        value = value.substr(0, value.find_last_not_of(" \t\r") + 1);
+        setOption(key, value);
+    }
+    return true;
+}
+
+// set one option by name, "profile" switches to a preset and keeps the options set after it
+void DbProfile::setOption(const string& key, const string& value) {
+    try {
+        if (key == "profile") {
+            *this = named(value);
+        }
+        else if (key == "journal_mode") {
+            string mode = upper(value);
+            if (mode != "WAL" && mode != "DELETE" && mode != "TRUNCATE" && mode != "PERSIST" && mode != "MEMORY") {
+                throw invalid_argument("use WAL, DELETE, TRUNCATE, PERSIST or MEMORY");
+            }
+            this->journalMode = mode;
+        }
+        else if (key == "synchronous") {
+            string level = upper(value);
+            if (level != "OFF" && level != "NORMAL" && level != "FULL" && level != "EXTRA") {
+                throw invalid_argument("use OFF, NORMAL, FULL or EXTRA");
+            }
+            this->synchronous = level;
+        }
+        else if (key == "mmap_size") {
+            this->mmapSize = stoll(value);
+        }
+        else if (key == "cache_size") {
+            this->cacheSize = stoi(value);
+        }
+        else if (key == "temp_store") {
+            string store = upper(value);
+            if (store != "DEFAULT" && store != "FILE" && store != "MEMORY") {
+                throw invalid_argument("use DEFAULT, FILE or MEMORY");
+            }
+            this->tempStore = store;
+        }
+        else if (key == "busy_timeout") {
+            this->busyTimeout = stoi(value);
+        }
+        else if (key == "checkpoint") {
+            string mode = upper(value);
+            if (mode != "NONE" && mode != "PASSIVE" && mode != "FULL" && mode != "TRUNCATE") {
+                throw invalid_argument("use NONE, PASSIVE, FULL or TRUNCATE");
+            }
+            this->checkpoint = mode;
+        }
+        else {
+            throw invalid_argument("unknown option");
+        }
+    }
+    catch (const logic_error& e) {
+        // stoi and friends throw their own invalid_argument and out_of_range
+        throw invalid_argument("Database option " + key + " = '" + value + "': " + e.what());
+    }
+}
+
+// pragma statements for the settings, in the order they should run
+vector<string> DbProfile::getPragmas() {
+    return {
+        "PRAGMA busy_timeout = " + to_string(this->busyTimeout) + ";",
+        "PRAGMA journal_mode = " + this->journalMode + ";",
+        "PRAGMA synchronous = " + this->synchronous + ";",
+        "PRAGMA mmap_size = " + to_string(this->mmapSize) + ";",
+        "PRAGMA cache_size = " + to_string(this->cacheSize) + ";",
+        "PRAGMA temp_store = " + this->tempStore + ";",
+    };
+}
+
+string DbProfile::getName() {
+    return this->name;
+}
+
+string DbProfile::getCheckpoint() {
+    return this->checkpoint;
+}
+
+string DbProfile::upper(string text) {
+    for (char& c : text) {
+        c = static_cast<char>(toupper(static_cast<unsigned char>(c)));
+    }
+    return text;
+}
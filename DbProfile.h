@@ -0,0 +1,38 @@
+#ifndef DBPROFILE_H
+#define DBPROFILE_H
+
+#include <stdexcept>
+#include <cctype>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// sqlite settings applied when the database is opened
+class DbProfile {
+public:
+    DbProfile();
+    static DbProfile safe();
+    static DbProfile fast();
+    static DbProfile named(const string& name);
+    bool loadFile(const string& path);
+    void setOption(const string& key, const string& value);
+    vector<string> getPragmas();
+    string getName();
+    string getCheckpoint();
+
+private:
+    static string upper(string text);
+
+    string name;
+    string journalMode; // WAL lets readers work during a write
+    string synchronous; // how often sqlite waits for the disk
+    long long mmapSize; // bytes of the file read through mmap, 0 turns it off
+    int cacheSize; // page cache, negative values are KiB
+    string tempStore; // where temp tables and sort b-trees live
+    int busyTimeout; // ms to wait on a lock held by another process
+    string checkpoint; // wal checkpoint run on exit: NONE, PASSIVE, FULL or TRUNCATE
+};
+
+#endif // DBPROFILE_H
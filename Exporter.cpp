@@ -0,0 +1,150 @@
+#include "Exporter.h"
+
+using namespace std;
+
+Exporter::Exporter(Database& db, Format format) : db(db), format(format) {
+    this->output = nullptr;
+    this->buffer.reserve(BUFFER_SIZE * 2);
+}
+
+// the format named on the command line
+Exporter::Format Exporter::parseFormat(const string& name) {
+    if (name == "jsonl") {
+        return Format::JsonLines;
+    }
+    if (name == "csv") {
+        return Format::Csv;
+    }
+    throw invalid_argument("Unknown export format " + name + ", use jsonl or csv.");
+}
+
+// write every task to the output, then how long it took to the report. returns the rows written
+long long Exporter::run(ostream& output, ostream& report) {
+    Trace::Span span("export");
+    this->output = &output;
+    this->buffer.clear();
+    auto started = chrono::steady_clock::now();
+    if (this->format == Format::Csv) {
+        this->buffer.append("id,board_id,board,title,description,stage,difficulty\r\n");
+    }
+    long long rows = this->db.forEachTask([this](const Database::TaskRow& row) { writeRow(row); });
+    flush();
+    this->output->flush();
+    if (!*this->output) {
+        throw runtime_error("Writing the export failed.");
+    }
+    this->output = nullptr;
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    report << "exported " << rows << " tasks in " << seconds << " s ("
+        << static_cast<long long>(rows / max(seconds, 1e-6)) << " rows/s)" << endl;
+    return rows;
+}
+
+void Exporter::writeRow(const Database::TaskRow& row) {
+    string& buffer = this->buffer;
+    if (this->format == Format::JsonLines) {
+        buffer.append("{\"id\":");
+        writeNumber(row.id);
+        buffer.append(",\"board_id\":");
+        writeNumber(row.boardId);
+        buffer.append(",\"board\":");
+        writeJsonString(row.boardTitle);
+        buffer.append(",\"title\":");
+        writeJsonString(row.title);
+        buffer.append(",\"description\":");
+        writeJsonString(row.description);
+        buffer.append(",\"stage\":");
+        writeJsonString(Task::stageToString(row.stage));
+        buffer.append(",\"difficulty\":");
+        writeNumber(row.difficulty);
+        buffer.append("}\n");
+    }
+    else {
+        // rfc 4180: comma separated, crlf line ends
+        writeNumber(row.id);
+        buffer.push_back(',');
+        writeNumber(row.boardId);
+        buffer.push_back(',');
+        writeCsvField(row.boardTitle);
+        buffer.push_back(',');
+        writeCsvField(row.title);
+        buffer.push_back(',');
+        writeCsvField(row.description);
+        buffer.push_back(',');
+        writeCsvField(Task::stageToString(row.stage));
+        buffer.push_back(',');
+        writeNumber(row.difficulty);
+        buffer.append("\r\n");
+    }
+    if (buffer.size() >= BUFFER_SIZE) {
+        flush();
+    }
+}
+
+void Exporter::writeJsonString(string_view text) {
+    // quotes, backslashes and control characters escaped, everything else copied in runs
+    static const char* hex = "0123456789abcdef";
+    string& buffer = this->buffer;
+    buffer.push_back('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        buffer.append(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+        buffer.push_back('\\');
+        switch (c) {
+        case '"': buffer.push_back('"'); break;
+        case '\\': buffer.push_back('\\'); break;
+        case '\n': buffer.push_back('n'); break;
+        case '\r': buffer.push_back('r'); break;
+        case '\t': buffer.push_back('t'); break;
+        default:
+            buffer.append("u00");
+            buffer.push_back(hex[c >> 4]);
+            buffer.push_back(hex[c & 0xf]);
+        }
+    }
+    buffer.append(text.data() + runStart, text.size() - runStart);
+    buffer.push_back('"');
+}
+
+void Exporter::writeCsvField(string_view text) {
+    // quoted only when it holds a separator, quote or line break. quotes inside are doubled
+    string& buffer = this->buffer;
+    bool needsQuotes = false;
+    for (char c : text) {
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            needsQuotes = true;
+            break;
+        }
+    }
+    if (!needsQuotes) {
+        buffer.append(text);
+        return;
+    }
+    buffer.push_back('"');
+    size_t runStart = 0;
+    for (size_t quote = text.find('"'); quote != string_view::npos; quote = text.find('"', quote + 1)) {
+        buffer.append(text.data() + runStart, quote + 1 - runStart);
+        buffer.push_back('"');
+        runStart = quote + 1;
+    }
+    buffer.append(text.data() + runStart, text.size() - runStart);
+    buffer.push_back('"');
+}
+
+void Exporter::writeNumber(long long number) {
+    char digits[24];
+    auto end = to_chars(digits, digits + sizeof(digits), number).ptr;
+    this->buffer.append(digits, end - digits);
+}
+
+// hand the buffered rows to the stream in one write
+void Exporter::flush() {
+    this->output->write(this->buffer.data(), static_cast<streamsize>(this->buffer.size()));
+    this->buffer.clear();
+}
@@ -0,0 +1,42 @@
+#ifndef EXPORTER_H
+#define EXPORTER_H
+
+#include "Database.h"
+#include "Task.h"
+#include "Trace.h"
+#include <iostream>
+#include <stdexcept>
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <algorithm>
+
+using namespace std;
+
+// streams every task out as JSON Lines or CSV. rows go from the database cursor into a
+// fixed size buffer and out to the stream, so memory stays flat whatever the database size
+class Exporter {
+public:
+    enum class Format { JsonLines, Csv };
+
+    static const size_t BUFFER_SIZE = 64 * 1024; // written out when this full
+
+    Exporter(Database& db, Format format);
+    static Format parseFormat(const string& name);
+    long long run(ostream& output, ostream& report);
+
+private:
+    void writeRow(const Database::TaskRow& row);
+    void writeJsonString(string_view text);
+    void writeCsvField(string_view text);
+    void writeNumber(long long number);
+    void flush();
+
+    Database& db;
+    Format format;
+    ostream* output; // set while running
+    string buffer; // reserved once, never grows past BUFFER_SIZE plus one field
+};
+
+#endif // EXPORTER_H
@@ -0,0 +1,433 @@
+#include "Importer.h"
+
+using namespace std;
+
+Importer::Importer(Database& db, Exporter::Format format) : db(db), format(format), rowBoard("import") {
+    this->deferIndexes = false;
+    this->output = nullptr;
+    this->position = 0;
+    this->readHeader = (format == Exporter::Format::Csv);
+    this->rowCount = 0;
+    this->importedCount = 0;
+    this->nextProgress = PROGRESS_ROWS;
+    this->rejectedCount = 0;
+    this->newBoardCount = 0;
+    this->batch.reserve(BATCH_SIZE);
+}
+
+void Importer::setDeferIndexes(bool defer) {
+    this->deferIndexes = defer;
+}
+
+// load every row of the input, returns the number of rows rejected
+long long Importer::run(istream& input, ostream& output) {
+    Trace::Span span("import");
+    this->output = &output;
+    this->started = chrono::steady_clock::now();
+    vector<Board*> existing = this->db.loadBoardsList();
+    for (Board* board : existing) {
+        // the first board of a title gets its tasks
+        this->boardIds.insert({ board->getTitle(), board->getId() });
+        delete board;
+    }
+
+    // with deferred indexes the whole load is one transaction, so a failed load never
+    // leaves the table without its indexes. otherwise each batch commits on its own
+    unique_ptr<Database::Batch> load;
+    if (this->deferIndexes) {
+        load = make_unique<Database::Batch>(this->db);
+        this->db.dropTaskIndexes();
+    }
+
+    vector<char> chunk(READ_SIZE);
+    bool atEnd = false;
+    while (!atEnd) {
+        input.read(chunk.data(), static_cast<streamsize>(chunk.size()));
+        this->pending.append(chunk.data(), static_cast<size_t>(input.gcount()));
+        atEnd = !input;
+        size_t end;
+        while (nextRecord(end, atEnd)) {
+            readRecord(string_view(this->pending).substr(this->position, end - this->position));
+            this->position = end;
+        }
+        // keep only the partial record for the next chunk
+        this->pending.erase(0, this->position);
+        this->position = 0;
+    }
+    flushBatch();
+
+    if (this->deferIndexes) {
+        output << "building indexes" << endl;
+        this->db.rebuildTaskIndexes();
+        load->commit();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - this->started).count();
+    output << "imported " << this->importedCount << " tasks (" << this->newBoardCount << " new boards) in "
+        << seconds << " s (" << static_cast<long long>(this->importedCount / max(seconds, 1e-6)) << " rows/s), "
+        << this->rejectedCount << " rows rejected" << endl;
+    this->output = nullptr;
+    return this->rejectedCount;
+}
+
+// find where the record at position ends, past its line break. the last record of the input
+// may have none. csv fields in quotes may hold line breaks, json lines never do
+bool Importer::nextRecord(size_t& end, bool atEnd) {
+    const string& pending = this->pending;
+    if (this->position >= pending.size()) {
+        return false;
+    }
+    size_t lineEnd = string::npos;
+    if (this->format == Exporter::Format::Csv) {
+        bool quoted = false;
+        for (size_t i = this->position; i < pending.size(); i++) {
+            if (pending[i] == '"') {
+                quoted = !quoted; // a doubled quote flips twice
+            }
+            else if (pending[i] == '\n' && !quoted) {
+                lineEnd = i;
+                break;
+            }
+        }
+    }
+    else {
+        lineEnd = pending.find('\n', this->position);
+    }
+    if (lineEnd != string::npos) {
+        end = lineEnd + 1;
+        return true;
+    }
+    if (atEnd) {
+        end = pending.size();
+        return true;
+    }
+    return false;
+}
+
+void Importer::readRecord(string_view record) {
+    // line ends are not part of the record, crlf or lf
+    while (!record.empty() && (record.back() == '\n' || record.back() == '\r')) {
+        record.remove_suffix(1);
+    }
+    if (record.empty()) {
+        return; // blank lines are skipped
+    }
+    if (this->readHeader) {
+        readCsvRecord(record);
+        return;
+    }
+
+    this->rowCount++;
+    try {
+        if (this->format == Exporter::Format::Csv) {
+            readCsvRecord(record);
+        }
+        else {
+            readJsonRecord(record);
+        }
+        addTask();
+    }
+    catch (const invalid_argument& e) {
+        this->rejectedCount++;
+        if (this->rejectedCount <= MAX_SHOWN_ERRORS) {
+            *this->output << "row " << this->rowCount << ": " << e.what() << endl;
+        }
+    }
+}
+
+// split a csv record into the fields wanted. the header record sets which column is which
+void Importer::readCsvRecord(string_view record) {
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        this->values[field].clear();
+        this->present[field] = false;
+    }
+    string& text = this->key; // the header's column names are read here
+    size_t column = 0;
+    size_t i = 0;
+    while (true) {
+        int field = -1;
+        if (!this->readHeader && column < this->columnFields.size()) {
+            field = this->columnFields[column];
+        }
+        string* value = (field >= 0) ? &this->values[field] : &text;
+        value->clear();
+        if (i < record.size() && record[i] == '"') {
+            // quoted field, "" is a quote inside it
+            i++;
+            while (true) {
+                size_t quote = record.find('"', i);
+                if (quote == string_view::npos) {
+                    throw invalid_argument("Missing closing quote.");
+                }
+                value->append(record.data() + i, quote - i);
+                i = quote + 1;
+                if (i < record.size() && record[i] == '"') {
+                    value->push_back('"');
+                    i++;
+                }
+                else {
+                    break;
+                }
+            }
+            if (i < record.size() && record[i] != ',') {
+                throw invalid_argument("Text after a closing quote.");
+            }
+        }
+        else {
+            size_t comma = min(record.find(',', i), record.size());
+            value->append(record.data() + i, comma - i);
+            i = comma;
+        }
+        if (field >= 0) {
+            this->present[field] = true;
+        }
+
+        if (this->readHeader) {
+            static const string names[FIELD_COUNT] = { "board", "title", "description", "stage", "difficulty" };
+            int named = -1;
+            for (int f = 0; f < FIELD_COUNT; f++) {
+                if (text == names[f]) {
+                    named = f;
+                }
+            }
+            this->columnFields.push_back(named);
+        }
+        column++;
+        if (i >= record.size()) {
+            break;
+        }
+        i++; // past the comma
+    }
+
+    if (this->readHeader) {
+        this->readHeader = false;
+        bool hasBoard = find(this->columnFields.begin(), this->columnFields.end(), BoardTitle) != this->columnFields.end();
+        bool hasTitle = find(this->columnFields.begin(), this->columnFields.end(), Title) != this->columnFields.end();
+        if (!hasBoard || !hasTitle) {
+            throw invalid_argument("The csv header needs board and title columns.");
+        }
+    }
+}
+
+// read a json object of strings, numbers and nulls into the fields wanted
+void Importer::readJsonRecord(string_view record) {
+    for (int field = 0; field < FIELD_COUNT; field++) {
+        this->values[field].clear();
+        this->present[field] = false;
+    }
+    static const string names[FIELD_COUNT] = { "board", "title", "description", "stage", "difficulty" };
+    auto skipSpace = [&record](size_t i) {
+        while (i < record.size() && (record[i] == ' ' || record[i] == '\t')) {
+            i++;
+        }
+        return i;
+    };
+
+    size_t i = skipSpace(0);
+    if (i >= record.size() || record[i] != '{') {
+        throw invalid_argument("Row is not a json object.");
+    }
+    i = skipSpace(i + 1);
+    if (i < record.size() && record[i] == '}') {
+        i = skipSpace(i + 1);
+    }
+    else {
+        while (true) {
+            i = readJsonString(record, i, this->key);
+            i = skipSpace(i);
+            if (i >= record.size() || record[i] != ':') {
+                throw invalid_argument("Expected : after \"" + this->key + "\".");
+            }
+            i = skipSpace(i + 1);
+            int field = -1;
+            for (int f = 0; f < FIELD_COUNT; f++) {
+                if (this->key == names[f]) {
+                    field = f;
+                }
+            }
+            string& value = this->values[(field >= 0) ? field : 0];
+            if (field < 0) {
+                // skipped values are read into the key, which isn't needed any more
+                if (i < record.size() && record[i] == '"') {
+                    i = readJsonString(record, i, this->key);
+                }
+                else {
+                    while (i < record.size() && record[i] != ',' && record[i] != '}') {
+                        if (record[i] == '{' || record[i] == '[') {
+                            throw invalid_argument("Nested values are not supported.");
+                        }
+                        i++;
+                    }
+                }
+            }
+            else if (i < record.size() && record[i] == '"') {
+                i = readJsonString(record, i, value);
+                this->present[field] = true;
+            }
+            else {
+                // numbers are kept as their text, null leaves the field unset
+                size_t start = i;
+                while (i < record.size() && record[i] != ',' && record[i] != '}' && record[i] != ' ') {
+                    i++;
+                }
+                string_view literal = record.substr(start, i - start);
+                if (literal.empty() || literal.find_first_of("{[") != string_view::npos) {
+                    throw invalid_argument("Bad value for \"" + names[field] + "\".");
+                }
+                if (literal != "null") {
+                    value.assign(literal);
+                    this->present[field] = true;
+                }
+            }
+            i = skipSpace(i);
+            if (i < record.size() && record[i] == ',') {
+                i = skipSpace(i + 1);
+                continue;
+            }
+            if (i < record.size() && record[i] == '}') {
+                i = skipSpace(i + 1);
+                break;
+            }
+            throw invalid_argument("Expected , or } in the row.");
+        }
+    }
+    if (i != record.size()) {
+        throw invalid_argument("Text after the json object.");
+    }
+}
+
+// read the json string starting at the quote at position, returns the position after it
+size_t Importer::readJsonString(string_view record, size_t position, string& text) {
+    if (position >= record.size() || record[position] != '"') {
+        throw invalid_argument("Expected a json string.");
+    }
+    text.clear();
+    size_t i = position + 1;
+    while (true) {
+        // copy the run up to the next quote or escape in one go
+        size_t stop = record.find_first_of("\"\\", i);
+        if (stop == string_view::npos) {
+            throw invalid_argument("Missing closing quote.");
+        }
+        text.append(record.data() + i, stop - i);
+        i = stop + 1;
+        if (record[stop] == '"') {
+            return i;
+        }
+        if (i >= record.size()) {
+            throw invalid_argument("Missing closing quote.");
+        }
+        char escaped = record[i++];
+        switch (escaped) {
+        case '"': text.push_back('"'); break;
+        case '\\': text.push_back('\\'); break;
+        case '/': text.push_back('/'); break;
+        case 'b': text.push_back('\b'); break;
+        case 'f': text.push_back('\f'); break;
+        case 'n': text.push_back('\n'); break;
+        case 'r': text.push_back('\r'); break;
+        case 't': text.push_back('\t'); break;
+        case 'u': {
+            auto readHex = [&record](size_t at) {
+                unsigned int value = 0;
+                if (at + 4 > record.size() || from_chars(record.data() + at, record.data() + at + 4, value, 16).ptr != record.data() + at + 4) {
+                    throw invalid_argument("Bad \\u escape.");
+                }
+                return value;
+            };
+            unsigned int codePoint = readHex(i);
+            i += 4;
+            if (codePoint >= 0xd800 && codePoint < 0xdc00 && i + 6 <= record.size() && record[i] == '\\' && record[i + 1] == 'u') {
+                // surrogate pair, the second half follows as its own escape
+                unsigned int low = readHex(i + 2);
+                if (low >= 0xdc00 && low < 0xe000) {
+                    codePoint = 0x10000 + ((codePoint - 0xd800) << 10) + (low - 0xdc00);
+                    i += 6;
+                }
+            }
+            appendUtf8(text, codePoint);
+            break;
+        }
+        default:
+            throw invalid_argument(string("Bad escape \\") + escaped + ".");
+        }
+    }
+}
+
+void Importer::appendUtf8(string& text, unsigned int codePoint) {
+    if (codePoint < 0x80) {
+        text.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800) {
+        text.push_back(static_cast<char>(0xc0 | (codePoint >> 6)));
+        text.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+    }
+    else if (codePoint < 0x10000) {
+        text.push_back(static_cast<char>(0xe0 | (codePoint >> 12)));
+        text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+        text.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+    }
+    else {
+        text.push_back(static_cast<char>(0xf0 | (codePoint >> 18)));
+        text.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f)));
+        text.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f)));
+        text.push_back(static_cast<char>(0x80 | (codePoint & 0x3f)));
+    }
+}
+
+// check the record with the same setters the app uses and queue it for the next insert
+void Importer::addTask() {
+    string* values = this->values;
+    if (!this->present[BoardTitle] || values[BoardTitle].empty()) {
+        throw invalid_argument("Row has no board.");
+    }
+    Task task(values[Title], this->rowBoard);
+    task.setTitle(move(values[Title]));
+    task.setDescription(move(values[Description]));
+    if (this->present[Difficulty] && !values[Difficulty].empty()) {
+        int rating = 0;
+        const string& text = values[Difficulty];
+        if (from_chars(text.data(), text.data() + text.size(), rating).ptr != text.data() + text.size()) {
+            throw invalid_argument("Difficulty must be a number 1 - 5.");
+        }
+        task.setDifficulty(rating);
+    }
+    if (this->present[StageName] && !values[StageName].empty()) {
+        task.setStage(Task::stringToStage(values[StageName]), true);
+    }
+    task.setBoardId(boardIdFor(values[BoardTitle]));
+    this->batch.push_back(move(task));
+    if (this->batch.size() >= BATCH_SIZE) {
+        flushBatch();
+    }
+}
+
+// id of the board with the title, adding the board the first time it is seen
+int Importer::boardIdFor(const string& title) {
+    auto found = this->boardIds.find(title);
+    if (found != this->boardIds.end()) {
+        return found->second;
+    }
+    Board board(title);
+    board.setTitle(title); // same length rule as boards made in the app
+    this->db.saveBoardData(board);
+    this->newBoardCount++;
+    this->boardIds.insert({ title, board.getId() });
+    return board.getId();
+}
+
+// insert the queued rows as one transaction and show progress now and then
+void Importer::flushBatch() {
+    if (this->batch.empty()) {
+        return;
+    }
+    this->db.insertTasks(this->batch);
+    this->importedCount += static_cast<long long>(this->batch.size());
+    this->batch.clear();
+    if (this->importedCount >= this->nextProgress) {
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - this->started).count();
+        *this->output << this->importedCount << " tasks, "
+            << static_cast<long long>(this->importedCount / max(seconds, 1e-6)) << " rows/s" << endl;
+        this->nextProgress += PROGRESS_ROWS;
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef IMPORTER_H
+#define IMPORTER_H
+
+#include "Database.h"
+#include "Exporter.h"
+#include "Board.h"
+#include "Task.h"
+#include "Trace.h"
+#include <iostream>
+#include <stdexcept>
+#include <charconv>
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+// loads tasks from JSON Lines or CSV, in the layout kanban export writes. input is read
+// a chunk at a time and each row is checked by the Task setters. valid rows are inserted
+// BATCH_SIZE per transaction. boards are matched by title, missing ones are added
+class Importer {
+public:
+    static const size_t READ_SIZE = 64 * 1024; // bytes read from the input at a time
+    static const size_t BATCH_SIZE = 10000; // rows per transaction
+    static const long long PROGRESS_ROWS = 100000; // a progress line after this many rows
+    static const int MAX_SHOWN_ERRORS = 10; // rejected rows listed, the rest only counted
+
+    Importer(Database& db, Exporter::Format format);
+    void setDeferIndexes(bool defer);
+    long long run(istream& input, ostream& output);
+
+private:
+    // the columns read, others are skipped
+    enum Field { BoardTitle, Title, Description, StageName, Difficulty, FIELD_COUNT };
+
+    bool nextRecord(size_t& end, bool atEnd);
+    void readRecord(string_view record);
+    void readCsvRecord(string_view record);
+    void readJsonRecord(string_view record);
+    static size_t readJsonString(string_view record, size_t position, string& text);
+    static void appendUtf8(string& text, unsigned int codePoint);
+    void addTask();
+    int boardIdFor(const string& title);
+    void flushBatch();
+
+    Database& db;
+    Exporter::Format format;
+    bool deferIndexes; // drop the indexes for the load and build them once after it
+    ostream* output; // set while running, for progress and rejected rows
+    string pending; // input read but not yet parsed, ends with a partial record
+    size_t position; // start of the next record in pending
+    bool readHeader; // csv only, the first record names the columns
+    vector<int> columnFields; // csv column to Field, -1 for skipped columns
+    string values[FIELD_COUNT]; // fields of the current record, reused
+    bool present[FIELD_COUNT];
+    string key; // json key being read, reused
+    map<string, int> boardIds; // board title to id
+    Board rowBoard; // stands in for each task's board while the row is checked
+    vector<Task> batch; // valid rows waiting to be inserted
+    long long rowCount; // records read, not counting the csv header
+    long long importedCount;
+    long long nextProgress; // imported count of the next progress line
+    long long rejectedCount;
+    int newBoardCount;
+    chrono::steady_clock::time_point started;
+};
+
+#endif // IMPORTER_H
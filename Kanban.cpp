@@ -2,27 +2,279 @@
 #include "UI.h"
 #include "Board.h"
 #include "Task.h"
+#include "DbProfile.h"
+#include "CommandRunner.h"
+#include "Benchmark.h"
+#include "Workload.h"
+#include "Session.h"
+#include "WriteBehind.h"
+#include "Prefetcher.h"
+#include "Stats.h"
+#include "Trace.h"
+#include "Snapshot.h"
+#include "SnapshotViewer.h"
+#include "Exporter.h"
+#include "Importer.h"
+#include "ConnectionPool.h"
+#include "ThreadPool.h"
+#include "Report.h"
+#include <cstdlib>
+#include <fstream>
 
 using namespace std;
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
-        // open DB
-        Database db("kanban_db.db");
-        // create display object
-        UI ui(db);
+        // sqlite counts memory under one global mutex by default, which parallel readers would
+        // all queue on. process wide options only take before the first connection is opened
+        if (sqlite3_config(SQLITE_CONFIG_MEMSTATUS, 0) != SQLITE_OK) {
+            throw runtime_error("Can't turn off sqlite's memory counter.");
+        }
+
+        // database settings come from kanban.conf (or the --config file),
+        // --profile replaces them with one of the presets
+        DbProfile profile;
+        string configPath = "kanban.conf";
+        string profileName;
+        string dbPath = "kanban_db.db";
+        string recordPath; // keys and typed lines of the interactive session are saved here
+        string snapshotPath; // browse this snapshot instead of a database
+        bool showStats = false; // print the session stats on exit
+        // spans are written to this chrome trace file, the variable sets it without a flag
+        const char* traceVariable = getenv("KANBAN_TRACE");
+        string tracePath = (traceVariable != nullptr) ? traceVariable : "";
+        vector<string> commandArgs; // subcommand and its arguments, none starts the interactive app
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (arg == "--config" && i + 1 < argc) {
+                configPath = argv[++i];
+            }
+            else if (arg == "--profile" && i + 1 < argc) {
+                profileName = argv[++i];
+            }
+            else if (arg == "--db" && i + 1 < argc) {
+                dbPath = argv[++i];
+            }
+            else if (arg == "--record" && i + 1 < argc) {
+                recordPath = argv[++i];
+            }
+            else if (arg == "--stats") {
+                showStats = true;
+            }
+            else if (arg == "--trace" && i + 1 < argc) {
+                tracePath = argv[++i];
+            }
+            else if (arg == "--snapshot" && i + 1 < argc) {
+                snapshotPath = argv[++i];
+            }
+            else if (arg.rfind("--", 0) != 0) {
+                // the rest of the line belongs to the subcommand
+                commandArgs.assign(argv + i, argv + argc);
+                break;
+            }
+            else {
+                commandArgs.clear();
+                commandArgs.push_back("--help");
+                break;
+            }
+        }
+        bool validCommand = commandArgs.empty()
+            || (commandArgs[0] == "exec" && commandArgs.size() <= 2)
+            || commandArgs[0] == "bench"
+            || commandArgs[0] == "generate"
+            || (commandArgs[0] == "replay" && (commandArgs.size() == 2 || commandArgs.size() == 4))
+            || (commandArgs[0] == "snapshot" && commandArgs.size() == 2)
+            || (commandArgs[0] == "restore" && commandArgs.size() == 2)
+            || (commandArgs[0] == "export" && (commandArgs.size() == 2 || commandArgs.size() == 3))
+            || (commandArgs[0] == "import" && (commandArgs.size() == 3 || commandArgs.size() == 4))
+            || (commandArgs[0] == "report" && (commandArgs.size() == 1 || commandArgs.size() == 3));
+        if (!validCommand) {
+            cerr << "Usage: kanban [--profile safe|fast] [--config file] [--db file] [--record session] [--stats]" << endl;
+            cerr << "              [--trace file.json]" << endl;
+            cerr << "       kanban --snapshot file    browse a snapshot, read only" << endl;
+            cerr << "       kanban exec [file]    run commands from the file or stdin, see Readme" << endl;
+            cerr << "       kanban bench [--sizes 1,1000,100000,1000000] [--boards 10] [--json file]" << endl;
+            cerr << "       kanban generate [--tasks 1000] [--boards 10] [--skew 0] [--title-length 10-40]" << endl;
+            cerr << "                       [--description-length 0-300] [--stages 40,30,30] [--difficulty 1,2,3,2,1] [--seed 1]" << endl;
+            cerr << "       kanban replay session [--latency file.csv]" << endl;
+            cerr << "       kanban snapshot file    write the database to a snapshot file" << endl;
+            cerr << "       kanban restore file     load a snapshot into an empty database" << endl;
+            cerr << "       kanban export jsonl|csv [file]    write every task to the file or stdout" << endl;
+            cerr << "       kanban import jsonl|csv file|- [--defer-indexes]    add tasks from the file or stdin" << endl;
+            cerr << "       kanban report [--threads N]    summarise every board, loading them in parallel" << endl;
+            return 1;
+        }
+        if (!profile.loadFile(configPath) && configPath != "kanban.conf") {
+            throw invalid_argument("Can't read config file " + configPath);
+        }
+        if (!profileName.empty()) {
+            profile = DbProfile::named(profileName);
+        }
+
+        // recording starts here and the file is written when main returns, after the
+        // writer and prefetcher threads below have stopped
+        Trace trace(tracePath);
+
+        if (!commandArgs.empty() && commandArgs[0] == "bench") {
+            // benchmarks make their own databases
+            Benchmark bench(profile, vector<string>(commandArgs.begin() + 1, commandArgs.end()));
+            return bench.run(cout);
+        }
+
+        if (!snapshotPath.empty()) {
+            // the snapshot is mapped and read in place, no database is opened
+            Snapshot snapshot(snapshotPath);
+            SnapshotViewer viewer(snapshot, snapshotPath);
+            viewer.run();
+            return 0;
+        }
+
+        // report threads each read through a connection of their own
+        int threadCount = ThreadPool::defaultThreadCount();
+        if (!commandArgs.empty() && commandArgs[0] == "report" && commandArgs.size() == 3) {
+            if (commandArgs[1] != "--threads") {
+                throw invalid_argument("Unknown report option " + commandArgs[1]);
+            }
+            threadCount = stoi(commandArgs[2]);
+        }
+        // the app reads through one reader for the screen and one for the prefetcher
+        int readerCount = 0;
+        if (commandArgs.empty() || commandArgs[0] == "replay") {
+            readerCount = 2;
+        }
+        else if (commandArgs[0] == "report") {
+            readerCount = threadCount;
+        }
+
+        // open DB, every connection comes from the pool. commands write through its writer
+        ConnectionPool pool(dbPath, profile, readerCount);
+        Database& db = pool.getWriter();
+
+        if (!commandArgs.empty() && commandArgs[0] == "report") {
+            ThreadPool threads(threadCount);
+            Report report(pool, threads);
+            report.run(cout);
+            return 0;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "snapshot") {
+            Snapshot::write(db, commandArgs[1], cout);
+            return 0;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "restore") {
+            Snapshot::restore(commandArgs[1], db, cout);
+            return 0;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "generate") {
+            // add generated boards and tasks
+            Workload workload;
+            workload.setArgs(vector<string>(commandArgs.begin() + 1, commandArgs.end()));
+            workload.generate(db, cout);
+            return 0;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "replay") {
+            // run a recorded session against the database, rendering offscreen
+            if (commandArgs.size() == 4 && commandArgs[2] != "--latency") {
+                throw invalid_argument("Unknown replay option " + commandArgs[2]);
+            }
+            Session session;
+            session.load(commandArgs[1]);
+            ConnectionPool::Lease screenReader(pool);
+            UI ui(*screenReader, true);
+            // edits are saved in the background like in the app, so key latencies match it
+            WriteBehind writer(pool.getWriter());
+            ui.setWriter(&writer);
+            ConnectionPool::Lease prefetchReader(pool);
+            Prefetcher prefetcher(*prefetchReader, &writer);
+            ui.setPrefetcher(&prefetcher);
+            int result = session.replay(ui, cout, (commandArgs.size() == 4) ? commandArgs[3] : "");
+            if (showStats) {
+                Stats::report(cout);
+            }
+            return result;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "export") {
+            Exporter exporter(db, Exporter::parseFormat(commandArgs[1]));
+            if (commandArgs.size() == 3) {
+                ofstream file(commandArgs[2], ios::binary);
+                if (!file) {
+                    throw invalid_argument("Can't write export file " + commandArgs[2]);
+                }
+                exporter.run(file, cout);
+                return 0;
+            }
+            // the rows go to stdout, so the timing goes to stderr
+            exporter.run(cout, cerr);
+            return 0;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "import") {
+            Importer importer(db, Exporter::parseFormat(commandArgs[1]));
+            if (commandArgs.size() == 4) {
+                if (commandArgs[3] != "--defer-indexes") {
+                    throw invalid_argument("Unknown import option " + commandArgs[3]);
+                }
+                importer.setDeferIndexes(true);
+            }
+            if (commandArgs[2] == "-") {
+                return (importer.run(cin, cout) == 0) ? 0 : 1;
+            }
+            ifstream file(commandArgs[2], ios::binary);
+            if (!file) {
+                throw invalid_argument("Can't read import file " + commandArgs[2]);
+            }
+            return (importer.run(file, cout) == 0) ? 0 : 1;
+        }
+
+        if (!commandArgs.empty() && commandArgs[0] == "exec") {
+            // headless mode, no screen or keyboard
+            CommandRunner runner(db, cout);
+            if (commandArgs.size() == 2) {
+                ifstream file(commandArgs[1]);
+                if (!file) {
+                    throw invalid_argument("Can't read command file " + commandArgs[1]);
+                }
+                return (runner.run(file) == 0) ? 0 : 1;
+            }
+            return (runner.run(cin) == 0) ? 0 : 1;
+        }
+
+        // create display object, it only reads. edits are saved by a background writer
+        // through the pool's writer connection
+        ConnectionPool::Lease screenReader(pool);
+        UI ui(*screenReader);
+        WriteBehind writer(pool.getWriter());
+        ui.setWriter(&writer);
+        // another reader loads boards near the selection before they are opened
+        ConnectionPool::Lease prefetchReader(pool);
+        Prefetcher prefetcher(*prefetchReader, &writer);
+        ui.setPrefetcher(&prefetcher);
 
         // load boards, set user selector position
         ui.reloadBoards();
         ui.setSelectIndex(0);
+        ui.prefetchAround();
+
+        Session recording;
+        if (!recordPath.empty()) {
+            recording.startRecording(recordPath, ui.getScreen().getHeight(), ui.getScreen().getWidth());
+            ui.setRecorder(&recording);
+        }
 
         // loop screen refresh and user command listening
-        while (true) {
+        while (ui.isRunning()) {
             // Display/Update the UI
             ui.displayScreen();
             // Listen for user input (pauses here until key press)
             ui.keyboardListen();
         }
+        if (showStats) {
+            Stats::report(cout);
+        }
     }
     catch (runtime_error& e) {
         cerr << "A runtime error occurred: " << e.what() << endl;
@@ -0,0 +1,179 @@
+#include "Prefetcher.h"
+
+using namespace std;
+
+Prefetcher::Prefetcher(Database& reader, WriteBehind* writer) : db(reader), writer(writer) {
+    this->pageSize = 0;
+    this->loading = 0;
+    this->cancelled = false;
+    this->stopping = false;
+    this->hitCount = 0;
+    this->cancelCount = 0;
+    this->prefetcher = thread(&Prefetcher::run, this);
+}
+
+Prefetcher::~Prefetcher() {
+    {
+        lock_guard<mutex> lock(this->stateMutex);
+        this->stopping = true;
+        cancelLoad();
+    }
+    this->wake.notify_one();
+    this->prefetcher.join();
+}
+
+// replace the boards wanted, pages of boards no longer wanted are dropped and their load cancelled
+void Prefetcher::request(const vector<int>& boardIds, int pageSize) {
+    lock_guard<mutex> lock(this->stateMutex);
+    if (boardIds == this->wanted && pageSize == this->pageSize) {
+        // the selection didn't move, there is nothing to do unless a page was forgotten or failed
+        bool missing = any_of(boardIds.begin(), boardIds.end(), [this](int boardId) { return this->pages.count(boardId) == 0; });
+        if (!missing) {
+            return;
+        }
+    }
+    this->wanted = boardIds;
+    this->pageSize = pageSize;
+    this->skipped.clear();
+    for (auto page = this->pages.begin(); page != this->pages.end();) {
+        if (find(boardIds.begin(), boardIds.end(), page->first) == boardIds.end()) {
+            page = this->pages.erase(page);
+        }
+        else {
+            page++;
+        }
+    }
+    if (this->loading != 0 && find(boardIds.begin(), boardIds.end(), this->loading) == boardIds.end()) {
+        cancelLoad();
+    }
+    this->wake.notify_one();
+}
+
+// hand over the prefetched page of a board that is being opened, never waits. a load of it
+// still running is cancelled, false when the caller has to load it
+bool Prefetcher::take(int boardId, Page& page) {
+    lock_guard<mutex> lock(this->stateMutex);
+    if (this->loading == boardId) {
+        // the caller's own query gets there sooner than waiting, both would share the disk.
+        // the board is open once it is loaded, so it isn't loaded again until the next request
+        cancelLoad();
+        this->skipped.push_back(boardId);
+        return false;
+    }
+    auto found = this->pages.find(boardId);
+    if (found == this->pages.end()) {
+        return false;
+    }
+    page = move(found->second);
+    this->pages.erase(found);
+    this->hitCount++;
+    return true;
+}
+
+// a board's tasks changed, drop what was loaded for it and wake the thread to load it again
+void Prefetcher::forget(int boardId) {
+    {
+        lock_guard<mutex> lock(this->stateMutex);
+        this->pages.erase(boardId);
+        if (this->loading == boardId) {
+            cancelLoad();
+        }
+    }
+    this->wake.notify_one();
+}
+
+long long Prefetcher::getHitCount() {
+    return this->hitCount;
+}
+
+long long Prefetcher::getCancelCount() {
+    return this->cancelCount;
+}
+
+// stop the running query, called with the state locked
+void Prefetcher::cancelLoad() {
+    if (this->loading != 0 && !this->cancelled) {
+        this->cancelled = true;
+        this->cancelCount++;
+        this->db.interrupt();
+    }
+}
+
+// first wanted board without a page, 0 for none. called with the state locked
+int Prefetcher::nextBoard() {
+    for (int boardId : this->wanted) {
+        if (this->pages.count(boardId) == 0 && find(this->skipped.begin(), this->skipped.end(), boardId) == this->skipped.end()) {
+            return boardId;
+        }
+    }
+    return 0;
+}
+
+void Prefetcher::run() {
+    Trace::nameThread("prefetcher");
+    while (true) {
+        int boardId;
+        int limit;
+        {
+            unique_lock<mutex> lock(this->stateMutex);
+            this->wake.wait(lock, [this]() { return this->stopping || nextBoard() != 0; });
+            if (this->stopping) {
+                return;
+            }
+            boardId = nextBoard();
+            limit = this->pageSize;
+            this->loading = boardId;
+            this->cancelled = false;
+        }
+
+        Page page;
+        bool failed = false;
+        try {
+            Trace::Span span("prefetch board");
+            // edits not written yet are taken before the read and laid over it, the writer is never waited on
+            WriteBehind::Pending edits;
+            if (this->writer != nullptr) {
+                edits = this->writer->pending();
+            }
+            // tasks only read the board id, the title isn't loaded
+            Board board("prefetch");
+            board.setId(boardId);
+            page.countsLoaded = !edits.touches(boardId);
+            if (page.countsLoaded) {
+                this->db.loadStageCounts(board);
+            }
+            for (int stage = 0; stage < 3; stage++) {
+                page.stageCounts[stage] = board.getStageCount(static_cast<Stage>(stage));
+            }
+            page.totalDifficulty = board.getTotalDifficulty();
+            page.tasks = this->db.loadTaskPage(board, -1, 0, limit);
+            bool full = (static_cast<int>(page.tasks.size()) == limit);
+            pair<int, int> last = { INT_MAX, INT_MAX };
+            if (full) {
+                last = { static_cast<int>(page.tasks.back().getStage()), page.tasks.back().getId() };
+            }
+            edits.merge(page.tasks, boardId, { -1, 1 }, last);
+            if (full && page.tasks.empty()) {
+                failed = true; // every task of the page was edited away, opening the board reads further
+            }
+        }
+        catch (const exception&) {
+            failed = true; // the board loads as usual when opened
+        }
+
+        {
+            lock_guard<mutex> lock(this->stateMutex);
+            // a cancelled load fails with SQLITE_INTERRUPT or ends early, either way it is
+            // dropped without counting as a failure, it loads again if wanted again
+            bool stillWanted = find(this->wanted.begin(), this->wanted.end(), boardId) != this->wanted.end();
+            if (failed && !this->cancelled) {
+                this->skipped.push_back(boardId);
+            }
+            else if (!failed && !this->cancelled && stillWanted && limit == this->pageSize) {
+                this->pages[boardId] = move(page);
+            }
+            this->loading = 0;
+            this->cancelled = false;
+        }
+    }
+}
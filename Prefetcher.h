@@ -0,0 +1,65 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include "Database.h"
+#include "WriteBehind.h"
+#include "Board.h"
+#include "Task.h"
+#include "Trace.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <climits>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+// loads the first page of boards the user is likely to open, on a thread with its own
+// reader connection from the pool. a load is cancelled when its board stops being wanted
+class Prefetcher {
+public:
+    // what opening a board loads: stage counts, the rating total and the first page of tasks
+    struct Page {
+        int stageCounts[3];
+        int totalDifficulty;
+        bool countsLoaded; // false when edits to the board were queued, the counts in memory are newer
+        vector<Task> tasks;
+    };
+
+    Prefetcher(Database& reader, WriteBehind* writer);
+    ~Prefetcher();
+    // owns a running thread, so copies are not allowed
+    Prefetcher(const Prefetcher&) = delete;
+    Prefetcher& operator=(const Prefetcher&) = delete;
+    void request(const vector<int>& boardIds, int pageSize);
+    bool take(int boardId, Page& page);
+    void forget(int boardId);
+    long long getHitCount();
+    long long getCancelCount();
+
+private:
+    void run();
+    int nextBoard();
+    void cancelLoad();
+
+    Database& db; // a reader lent by the pool, only used on the prefetch thread after construction
+    WriteBehind* writer; // queued edits are laid over a load so it sees them, may be null
+    mutex stateMutex;
+    condition_variable wake; // the thread waits here for wanted boards
+    vector<int> wanted; // boards to load, most likely to open first
+    int pageSize;
+    map<int, Page> pages; // finished loads of wanted boards
+    vector<int> skipped; // boards whose load failed, not retried until the next request
+    int loading; // board being loaded, 0 for none
+    bool cancelled; // the load in flight is no longer wanted
+    bool stopping;
+    atomic<long long> hitCount; // boards opened from a prefetched page
+    atomic<long long> cancelCount; // loads cancelled part way
+    thread prefetcher; // started last, after everything it reads is set up
+};
+
+#endif // PREFETCHER_H
@@ -0,0 +1,58 @@
+#include "Report.h"
+
+using namespace std;
+
+Report::Report(ConnectionPool& pool, ThreadPool& threads) : pool(pool), threads(threads) {
+}
+
+void Report::run(ostream& output) {
+    Trace::Span span("report");
+    auto started = chrono::steady_clock::now();
+    vector<Board*> boards;
+    {
+        ConnectionPool::Lease reader(this->pool);
+        boards = reader->loadBoardsList();
+    }
+    vector<vector<Task>> tasks;
+    try {
+        tasks = this->pool.loadBoardTasks(boards, this->threads);
+    }
+    catch (...) {
+        for (Board* board : boards) {
+            delete board;
+        }
+        throw;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+    size_t titleWidth = 5; // "Board"
+    for (Board* board : boards) {
+        titleWidth = max(titleWidth, board->getTitle().length());
+    }
+    output << left << setw(static_cast<int>(titleWidth)) << "Board" << right
+        << setw(10) << "Tasks" << setw(8) << "To Do" << setw(13) << "In Progress" << setw(8) << "Done"
+        << setw(16) << "Avg Difficulty" << setw(12) << "Described" << endl;
+
+    long long totalTasks = 0;
+    for (size_t b = 0; b < boards.size(); b++) {
+        long long stageCounts[3] = { 0, 0, 0 };
+        long long difficulty = 0;
+        long long described = 0;
+        for (Task& task : tasks[b]) {
+            stageCounts[static_cast<int>(task.getStage())]++;
+            difficulty += task.getDifficulty();
+            described += task.getDescription().empty() ? 0 : 1;
+        }
+        long long count = static_cast<long long>(tasks[b].size());
+        totalTasks += count;
+        output << left << setw(static_cast<int>(titleWidth)) << boards[b]->getTitle() << right
+            << setw(10) << count << setw(8) << stageCounts[0] << setw(13) << stageCounts[1] << setw(8) << stageCounts[2]
+            << setw(16) << fixed << setprecision(2) << (count > 0 ? static_cast<double>(difficulty) / count : 0.0)
+            << setw(11) << setprecision(1) << (count > 0 ? 100.0 * described / count : 0.0) << "%" << endl;
+        delete boards[b];
+    }
+    output << defaultfloat << setprecision(6);
+    output << "loaded " << totalTasks << " tasks from " << boards.size() << " boards in " << seconds * 1000 << " ms on "
+        << this->threads.getThreadCount() << " threads (" << static_cast<long long>(totalTasks / max(seconds, 1e-6))
+        << " rows/s)" << endl;
+}
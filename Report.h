@@ -0,0 +1,30 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "ConnectionPool.h"
+#include "ThreadPool.h"
+#include "Board.h"
+#include "Task.h"
+#include "Trace.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// a summary of every board made from all of its tasks. the boards are loaded side by side
+// through the pool's readers, one job per board on the thread pool
+class Report {
+public:
+    Report(ConnectionPool& pool, ThreadPool& threads);
+    void run(ostream& output);
+
+private:
+    ConnectionPool& pool;
+    ThreadPool& threads;
+};
+
+#endif // REPORT_H
@@ -0,0 +1,314 @@
+#include "ScreenBuffer.h"
+
+#ifdef _WIN32
+// exclude parts of <windows.h> causing build errors
+#define WIN32_LEAN_AND_MEAN
+#define RPC_NO_WINDOWS_H
+#define NOMINMAX // keep std::min and std::max usable
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <cerrno>
+#endif
+
+using namespace std;
+
+ScreenBuffer::ScreenBuffer(bool offscreen) {
+    this->offscreen = offscreen;
+    this->lineCount = 0;
+    this->shownCount = 0;
+    this->color = TextColor::Bright;
+    this->redrawAll = true;
+    this->height = 40;
+    this->width = 120;
+    this->frameBytes = 0;
+    this->frameWrites = 0;
+    this->totalBytes = 0;
+    this->totalWrites = 0;
+    this->frame.resize(1);
+    this->frameColors.resize(1, TextColor::Bright);
+
+#ifdef _WIN32
+    // let the windows console understand ansi escape sequences
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (!offscreen && GetConsoleMode(hConsole, &mode)) {
+        SetConsoleMode(hConsole, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+    }
+#endif
+    updateSize();
+}
+
+void ScreenBuffer::beginFrame() {
+    // start an empty frame, line strings keep their memory for reuse
+    this->lineCount = 0;
+    this->color = TextColor::Bright;
+    updateSize();
+    this->frame[0].clear();
+    this->frameColors[0] = this->color;
+}
+
+void ScreenBuffer::write(string_view text) {
+    // add text to the frame, each newline starts a new line
+    size_t start = 0;
+    size_t end = text.find('\n');
+    while (end != string_view::npos) {
+        this->frame[this->lineCount].append(text.substr(start, end - start));
+        newLine();
+        start = end + 1;
+        end = text.find('\n', start);
+    }
+    this->frame[this->lineCount].append(text.substr(start));
+}
+
+void ScreenBuffer::writeWrapped(string_view text, string_view margin, int lineLength) {
+    // wrap text at word breaks, each word is written straight from the text.
+    // the first line is indented more than the rest
+    static const char* spaces = " \t\n\v\f\r";
+    write(margin);
+    write("    ");
+    size_t currentLength = margin.size() + 4;
+
+    size_t start = text.find_first_not_of(spaces);
+    while (start != string_view::npos) {
+        size_t end = text.find_first_of(spaces, start);
+        string_view word = text.substr(start, end - start);
+        if (currentLength + word.size() > static_cast<size_t>(lineLength)) {
+            write("\n");
+            write(margin);
+            write(" ");
+            currentLength = margin.size() + 1;
+        }
+        write(word);
+        write(" ");
+        currentLength += word.size() + 1;
+        start = text.find_first_not_of(spaces, end);
+    }
+    write("\n");
+}
+
+void ScreenBuffer::setColor(const TextColor color) {
+    if (this->frame[this->lineCount].empty()) {
+        // nothing written on this line yet, just change the color it starts with
+        this->frameColors[this->lineCount] = color;
+    }
+    else if (color != this->color) {
+        this->frame[this->lineCount].append(colorCode(color));
+    }
+    this->color = color;
+}
+
+void ScreenBuffer::present() {
+    // write only the lines that differ from what is on screen, in one write call.
+    // rows below the terminal are left out, they would scroll the screen
+    size_t total = this->lineCount + (this->frame[this->lineCount].empty() ? 0 : 1);
+    total = min(total, static_cast<size_t>(max(this->height, 1)));
+    bool changed = this->redrawAll;
+    this->output.clear();
+
+    if (this->redrawAll) {
+        this->output.append("\x1b[H\x1b[2J"); // cursor home, clear screen
+    }
+    for (size_t i = 0; i < total; i++) {
+        bool lineChanged = this->redrawAll || i >= this->shownCount
+            || this->frameColors[i] != this->shownColors[i] || this->frame[i] != this->shown[i];
+        if (lineChanged) {
+            // move to the row, draw the line and clear whatever was left after it
+            this->output.append("\x1b[").append(to_string(i + 1)).append(";1H");
+            this->output.append(colorCode(this->frameColors[i]));
+            if (!appendClipped(this->frame[i])) {
+                this->output.append("\x1b[K");
+            }
+
+            // remember what is on screen now
+            if (i >= this->shown.size()) {
+                this->shown.resize(i + 1);
+                this->shownColors.resize(i + 1);
+            }
+            this->shown[i].assign(this->frame[i]);
+            this->shownColors[i] = this->frameColors[i];
+            changed = true;
+        }
+    }
+    if (!this->redrawAll && this->shownCount > total) {
+        // clear rows left over from a longer previous frame
+        this->output.append("\x1b[").append(to_string(total + 1)).append(";1H\x1b[J");
+        changed = true;
+    }
+    this->shownCount = total;
+    this->redrawAll = false;
+
+    this->frameBytes = 0;
+    this->frameWrites = 0;
+    if (changed) {
+        // leave the cursor below the frame for prompts, or on the last row of a full screen
+        size_t cursorRow = min(total + 1, static_cast<size_t>(max(this->height, 1)));
+        this->output.append("\x1b[").append(to_string(cursorRow)).append(";1H");
+        this->output.append(colorCode(TextColor::Bright));
+        writeOutput(this->output);
+    }
+}
+
+void ScreenBuffer::invalidate() {
+    // screen content is unknown, e.g. after a prompt, redraw everything next frame
+    this->redrawAll = true;
+}
+
+void ScreenBuffer::setSize(int rows, int columns) {
+    // fixed size for an offscreen buffer, a terminal's size is read every frame instead
+    if (rows != this->height || columns != this->width) {
+        this->height = rows;
+        this->width = columns;
+        this->redrawAll = true;
+    }
+}
+
+int ScreenBuffer::getLineCount() {
+    return static_cast<int>(this->lineCount);
+}
+
+int ScreenBuffer::getHeight() {
+    return this->height;
+}
+
+int ScreenBuffer::getWidth() {
+    return this->width;
+}
+
+long long ScreenBuffer::getFrameBytes() {
+    return this->frameBytes;
+}
+
+long long ScreenBuffer::getFrameWrites() {
+    return this->frameWrites;
+}
+
+long long ScreenBuffer::getTotalBytes() {
+    return this->totalBytes;
+}
+
+long long ScreenBuffer::getTotalWrites() {
+    return this->totalWrites;
+}
+
+void ScreenBuffer::newLine() {
+    // open the next line, reusing an old string if there is one
+    this->lineCount++;
+    if (this->lineCount >= this->frame.size()) {
+        this->frame.emplace_back();
+        this->frameColors.push_back(this->color);
+    }
+    else {
+        this->frame[this->lineCount].clear();
+        this->frameColors[this->lineCount] = this->color;
+    }
+}
+
+void ScreenBuffer::updateSize() {
+    // read the terminal size, keeping the last known size if it can't be read
+    if (this->offscreen) {
+        return;
+    }
+    int rows = this->height;
+    int columns = this->width;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        rows = info.srWindow.Bottom - info.srWindow.Top + 1;
+        columns = info.srWindow.Right - info.srWindow.Left + 1;
+    }
+#else
+    struct winsize size;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == 0 && size.ws_row > 0) {
+        rows = size.ws_row;
+        columns = size.ws_col;
+    }
+#endif
+    if (rows != this->height || columns != this->width) {
+        // lines may have wrapped or moved, redraw everything
+        this->height = rows;
+        this->width = columns;
+        this->redrawAll = true;
+    }
+}
+
+bool ScreenBuffer::appendClipped(const string& line) {
+    // add a line cut at the terminal width, so it never wraps onto the next row.
+    // escape codes take no columns and utf-8 continuation bytes belong to the character before.
+    // returns true when the line fills the row, clearing after it would erase its last character
+    if (line.size() < static_cast<size_t>(this->width)) {
+        // fewer bytes than columns, it fits whatever it holds
+        this->output.append(line);
+        return false;
+    }
+    int columns = 0;
+    size_t i = 0;
+    while (i < line.size()) {
+        if (line[i] == '\x1b' && i + 1 < line.size() && line[i + 1] == '[') {
+            // copy the whole sequence up to its final letter
+            size_t end = i + 2;
+            while (end < line.size() && !(line[end] >= '@' && line[end] <= '~')) {
+                end++;
+            }
+            end = min(end + 1, line.size());
+            this->output.append(line, i, end - i);
+            i = end;
+            continue;
+        }
+        if ((static_cast<unsigned char>(line[i]) & 0xC0) != 0x80) {
+            if (columns == this->width) {
+                return true;
+            }
+            columns++;
+        }
+        this->output.push_back(line[i]);
+        i++;
+    }
+    return columns >= this->width;
+}
+
+void ScreenBuffer::writeOutput(const string& data) {
+    size_t written = 0;
+    if (this->offscreen) {
+        // count it as one write that went through
+        written = data.size();
+        this->frameWrites = 1;
+    }
+#ifdef _WIN32
+    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+    while (written < data.size()) {
+        DWORD count = 0;
+        this->frameWrites++;
+        if (!WriteFile(hConsole, data.data() + written, static_cast<DWORD>(data.size() - written), &count, nullptr)) {
+            break;
+        }
+        written += count;
+    }
+#else
+    while (written < data.size()) {
+        this->frameWrites++;
+        ssize_t count = ::write(STDOUT_FILENO, data.data() + written, data.size() - written);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(count);
+    }
+#endif
+    this->frameBytes = static_cast<long long>(written);
+    this->totalBytes += this->frameBytes;
+    this->totalWrites += this->frameWrites;
+}
+
+const char* ScreenBuffer::colorCode(const TextColor color) {
+    // ansi color sequences
+    switch (color) {
+    case TextColor::Bright: return "\x1b[97m";
+    case TextColor::Normal: return "\x1b[37m";
+    case TextColor::Highlight: return "\x1b[92m";
+    }
+    return "\x1b[0m";
+}
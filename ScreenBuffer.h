@@ -0,0 +1,60 @@
+#ifndef SCREENBUFFER_H
+#define SCREENBUFFER_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+enum class TextColor {
+    Bright,
+    Normal,
+    Highlight
+};
+
+class ScreenBuffer {
+public:
+    ScreenBuffer(bool offscreen = false);
+    void beginFrame();
+    void write(string_view text);
+    void writeWrapped(string_view text, string_view margin, int lineLength);
+    void setColor(const TextColor color);
+    void present();
+    void invalidate();
+    void setSize(int rows, int columns);
+    int getLineCount();
+    int getHeight();
+    int getWidth();
+    long long getFrameBytes();
+    long long getFrameWrites();
+    long long getTotalBytes();
+    long long getTotalWrites();
+
+private:
+    void newLine();
+    void updateSize();
+    bool appendClipped(const string& line);
+    void writeOutput(const string& data);
+    static const char* colorCode(const TextColor color);
+
+    vector<string> frame; // lines of the frame being built, kept to reuse their memory
+    vector<TextColor> frameColors; // color in effect at the start of each line
+    vector<string> shown; // lines currently on the terminal
+    vector<TextColor> shownColors;
+    size_t lineCount; // lines used in frame
+    size_t shownCount; // lines used in shown
+    TextColor color;
+    int height; // terminal rows
+    int width; // terminal columns
+    bool redrawAll;
+    bool offscreen; // frames are built and diffed but never written, for benchmarks
+    string output; // escape sequences and text sent in one write per frame
+    long long frameBytes;
+    long long frameWrites;
+    long long totalBytes;
+    long long totalWrites;
+};
+
+#endif // SCREENBUFFER_H
@@ -0,0 +1,136 @@
+#include "Session.h"
+#include "UI.h"
+#include "Benchmark.h"
+
+using namespace std;
+
+// session file: a header line, the screen size, then one "key <code>" or "line <text>" per event
+static const string SESSION_HEADER = "kanban-session 1";
+
+Session::Session() {
+    this->position = 0;
+    this->rows = 40;
+    this->columns = 120;
+}
+
+void Session::startRecording(const string& path, int rows, int columns) {
+    this->recording.open(path);
+    if (!this->recording) {
+        throw runtime_error("Can't write session file " + path);
+    }
+    this->recording << SESSION_HEADER << "\n" << "size " << rows << " " << columns << "\n";
+}
+
+void Session::recordKey(int key) {
+    // flushed every key, a session that ends in a crash is the one worth replaying
+    this->recording << "key " << key << endl;
+}
+
+void Session::recordLine(const string& line) {
+    this->recording << "line " << line << endl;
+}
+
+void Session::load(const string& path) {
+    ifstream file(path);
+    string text;
+    if (!file || !getline(file, text) || text != SESSION_HEADER) {
+        throw runtime_error(path + " is not a kanban session file.");
+    }
+    this->events.clear();
+    this->position = 0;
+    while (getline(file, text)) {
+        if (text.rfind("size ", 0) == 0) {
+            stringstream size(text.substr(5));
+            size >> this->rows >> this->columns;
+        }
+        else if (text.rfind("key ", 0) == 0) {
+            this->events.push_back({ true, stoi(text.substr(4)), "" });
+        }
+        else if (text.rfind("line ", 0) == 0) {
+            this->events.push_back({ false, 0, text.substr(5) });
+        }
+        else if (!text.empty()) {
+            throw runtime_error(path + ": unexpected line '" + text + "'");
+        }
+    }
+}
+
+bool Session::hasKey() {
+    return this->position < this->events.size();
+}
+
+int Session::nextKey() {
+    if (!hasKey() || !this->events[this->position].isKey) {
+        throw runtime_error("Session replay out of step at event " + to_string(this->position + 1) + ": expected a key.");
+    }
+    return this->events[this->position++].key;
+}
+
+string Session::nextLine() {
+    // a prompt asks for a line, the session must have one recorded here
+    if (!hasKey() || this->events[this->position].isKey) {
+        throw runtime_error("Session replay out of step at event " + to_string(this->position + 1) + ": expected a typed line.");
+    }
+    return this->events[this->position++].line;
+}
+
+// feed the recorded keys to the UI, rendering each frame offscreen, and report the time per key
+int Session::replay(UI& ui, ostream& output, const string& latencyPath) {
+    ui.getScreen().setSize(this->rows, this->columns);
+    ui.setReplay(this);
+    ui.reloadBoards();
+    ui.setSelectIndex(0);
+    ui.prefetchAround();
+    ui.displayScreen();
+
+    vector<int> keys;
+    vector<double> latencies; // microseconds from key to finished frame
+    while (ui.isRunning() && hasKey()) {
+        int key = nextKey();
+        auto start = chrono::steady_clock::now();
+        ui.handleKey(key);
+        if (ui.isRunning()) {
+            ui.displayScreen();
+        }
+        latencies.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+        keys.push_back(key);
+    }
+    ui.setReplay(nullptr);
+
+    vector<double> sorted = latencies;
+    sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (double latency : sorted) {
+        total += latency;
+    }
+    output << fixed << setprecision(1);
+    output << keys.size() << " keys replayed in " << total / 1000 << " ms. per key: p50 " << Benchmark::percentile(sorted, 0.5)
+        << " us, p90 " << Benchmark::percentile(sorted, 0.9) << " us, p99 " << Benchmark::percentile(sorted, 0.99)
+        << " us, max " << (sorted.empty() ? 0 : sorted.back()) << " us" << endl;
+
+    // slowest keys, to find the step a complaint is about
+    vector<size_t> order(latencies.size());
+    for (size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return latencies[a] > latencies[b]; });
+    for (size_t i = 0; i < min<size_t>(5, order.size()); i++) {
+        output << "  key #" << order[i] + 1 << " (" << keys[order[i]] << "): " << latencies[order[i]] << " us" << endl;
+    }
+    output << defaultfloat;
+
+    if (!latencyPath.empty()) {
+        ofstream file(latencyPath);
+        if (!file) {
+            throw runtime_error("Can't write latencies to " + latencyPath);
+        }
+        file << "index,key,microseconds\n";
+        for (size_t i = 0; i < latencies.size(); i++) {
+            file << i + 1 << "," << keys[i] << "," << latencies[i] << "\n";
+        }
+    }
+    if (hasKey()) {
+        output << "session quit with " << this->events.size() - this->position << " events left" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class UI;
+
+// a recorded stream of keys and typed prompt lines, written while the app runs and replayed headlessly
+class Session {
+public:
+    Session();
+    void startRecording(const string& path, int rows, int columns);
+    void recordKey(int key);
+    void recordLine(const string& line);
+    void load(const string& path);
+    bool hasKey();
+    int nextKey();
+    string nextLine();
+    int replay(UI& ui, ostream& output, const string& latencyPath);
+
+private:
+    // one key press or one line typed at a prompt
+    struct Event {
+        bool isKey;
+        int key;
+        string line;
+    };
+
+    ofstream recording;
+    vector<Event> events;
+    size_t position; // next event to replay
+    int rows; // screen size the session was recorded at
+    int columns;
+};
+
+#endif // SESSION_H
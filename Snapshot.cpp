@@ -0,0 +1,327 @@
+#include "Snapshot.h"
+
+#ifdef _WIN32
+// exclude parts of <windows.h> causing build errors
+#define WIN32_LEAN_AND_MEAN
+#define RPC_NO_WINDOWS_H
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char SNAPSHOT_MAGIC[8] = { 'K', 'A', 'N', 'B', 'A', 'N', 'S', 'S' };
+
+// entries are read straight from the mapping, their layout is the file format
+static_assert(sizeof(Snapshot::Header) == 64, "snapshot header layout changed");
+static_assert(sizeof(Snapshot::BoardEntry) == 40, "snapshot board layout changed");
+static_assert(sizeof(Snapshot::TaskEntry) == 40, "snapshot task layout changed");
+
+Snapshot::Snapshot(const string& path) {
+    this->data = nullptr;
+    this->size = 0;
+#ifdef _WIN32
+    this->file = INVALID_HANDLE_VALUE;
+    this->mapping = nullptr;
+#endif
+    map(path);
+
+    // only the header and table bounds are checked, so opening costs the same at any size.
+    // string ranges are checked when they are read
+    const uint64_t headerSize = sizeof(Header);
+    if (this->size < headerSize || memcmp(this->data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        unmap();
+        throw runtime_error(path + " is not a kanban snapshot.");
+    }
+    this->header = reinterpret_cast<const Header*>(this->data);
+    const Header& h = *this->header;
+    bool valid = h.version == VERSION
+        && h.boardsOffset == headerSize
+        && h.tasksOffset == h.boardsOffset + h.boardCount * sizeof(BoardEntry)
+        && h.tasksOffset <= this->size
+        && h.taskCount <= (this->size - h.tasksOffset) / sizeof(TaskEntry)
+        && h.stringsOffset == h.tasksOffset + h.taskCount * sizeof(TaskEntry)
+        && h.stringsOffset <= this->size
+        && h.stringsSize <= this->size - h.stringsOffset;
+    if (!valid) {
+        unmap();
+        throw runtime_error(path + " is damaged or from another version of kanban.");
+    }
+    this->boards = reinterpret_cast<const BoardEntry*>(this->data + h.boardsOffset);
+    this->tasks = reinterpret_cast<const TaskEntry*>(this->data + h.tasksOffset);
+    this->strings = this->data + h.stringsOffset;
+}
+
+Snapshot::~Snapshot() {
+    unmap();
+}
+
+// write every board and task of the database to a new snapshot file
+void Snapshot::write(Database& db, const string& path, ostream& output) {
+    // one transaction, so the task counts and the tasks read agree
+    Database::Batch batch(db);
+    vector<Board*> boards = db.loadBoardsList();
+    // written next to the target and renamed at the end, a failed write leaves no half snapshot
+    string partPath = path + ".part";
+    try {
+        Header header = {};
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        header.version = VERSION;
+        header.boardCount = static_cast<uint32_t>(boards.size());
+        for (Board* board : boards) {
+            header.taskCount += static_cast<uint64_t>(board->getTaskCount());
+        }
+        header.boardsOffset = sizeof(Header);
+        header.tasksOffset = header.boardsOffset + header.boardCount * sizeof(BoardEntry);
+        header.stringsOffset = header.tasksOffset + header.taskCount * sizeof(TaskEntry);
+        header.createdAt = static_cast<int64_t>(time(nullptr));
+
+        ofstream file(partPath, ios::binary | ios::trunc);
+        if (!file) {
+            throw runtime_error("Can't write snapshot " + partPath);
+        }
+
+        // the tables are sized up front, so each page of tasks goes to its place in the task
+        // table and its text to the end of the heap. only one page is held in memory
+        vector<BoardEntry> boardEntries;
+        vector<TaskEntry> page;
+        string pageStrings;
+        uint64_t written = 0;
+        for (Board* board : boards) {
+            BoardEntry entry = {};
+            entry.id = board->getId();
+            entry.titleOffset = header.stringsSize;
+            entry.titleLength = static_cast<uint32_t>(board->getTitle().size());
+            entry.firstTask = written;
+            for (int stage = 0; stage < 3; stage++) {
+                entry.stageCounts[stage] = static_cast<uint32_t>(board->getStageCount(static_cast<Stage>(stage)));
+            }
+            entry.totalDifficulty = static_cast<uint32_t>(board->getTotalDifficulty());
+            boardEntries.push_back(entry);
+            file.seekp(static_cast<streamoff>(header.stringsOffset + header.stringsSize));
+            file.write(board->getTitle().data(), entry.titleLength);
+            header.stringsSize += entry.titleLength;
+
+            int afterRank = -1;
+            int afterId = 0;
+            while (true) {
+                vector<Task> loaded = db.loadTaskPage(*board, afterRank, afterId, WRITE_PAGE_SIZE);
+                if (loaded.empty()) {
+                    break;
+                }
+                page.clear();
+                pageStrings.clear();
+                for (Task& task : loaded) {
+                    TaskEntry taskEntry = {};
+                    taskEntry.id = task.getId();
+                    taskEntry.boardId = board->getId();
+                    taskEntry.titleOffset = header.stringsSize + pageStrings.size();
+                    taskEntry.titleLength = static_cast<uint32_t>(task.getTitle().size());
+                    pageStrings.append(task.getTitle());
+                    taskEntry.descriptionOffset = header.stringsSize + pageStrings.size();
+                    taskEntry.descriptionLength = static_cast<uint32_t>(task.getDescription().size());
+                    pageStrings.append(task.getDescription());
+                    taskEntry.stage = static_cast<uint8_t>(task.getStage());
+                    taskEntry.difficulty = static_cast<uint8_t>(task.getDifficulty());
+                    page.push_back(taskEntry);
+                }
+                if (written + page.size() > header.taskCount) {
+                    throw runtime_error("Board " + board->getTitle() + " changed while the snapshot was written.");
+                }
+                file.seekp(static_cast<streamoff>(header.tasksOffset + written * sizeof(TaskEntry)));
+                file.write(reinterpret_cast<const char*>(page.data()), static_cast<streamsize>(page.size() * sizeof(TaskEntry)));
+                file.seekp(static_cast<streamoff>(header.stringsOffset + header.stringsSize));
+                file.write(pageStrings.data(), static_cast<streamsize>(pageStrings.size()));
+                header.stringsSize += pageStrings.size();
+                written += page.size();
+                afterRank = static_cast<int>(loaded.back().getStage());
+                afterId = loaded.back().getId();
+            }
+            if (written != entry.firstTask + board->getTaskCount()) {
+                throw runtime_error("Board " + board->getTitle() + " changed while the snapshot was written.");
+            }
+        }
+
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(boardEntries.data()), static_cast<streamsize>(boardEntries.size() * sizeof(BoardEntry)));
+        file.close();
+        if (!file) {
+            throw runtime_error("Can't write snapshot " + partPath);
+        }
+        // replaces the old snapshot in one step, it is kept if the move fails
+#ifdef _WIN32
+        bool moved = MoveFileExA(partPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool moved = rename(partPath.c_str(), path.c_str()) == 0;
+#endif
+        if (!moved) {
+            throw runtime_error("Can't move the snapshot to " + path);
+        }
+        output << "snapshot of " << header.boardCount << " boards and " << header.taskCount << " tasks written to "
+            << path << " (" << (header.stringsOffset + header.stringsSize) / 1024 << " KB)" << endl;
+    }
+    catch (...) {
+        // the part file was closed when the try block ended
+        remove(partPath.c_str());
+        for (Board* board : boards) {
+            delete board;
+        }
+        throw;
+    }
+    for (Board* board : boards) {
+        delete board;
+    }
+}
+
+// copy a snapshot into a database that has no boards yet, keeping every id
+void Snapshot::restore(const string& path, Database& db, ostream& output) {
+    Snapshot snapshot(path);
+    vector<Board*> existing = db.loadBoardsList();
+    bool empty = existing.empty();
+    for (Board* board : existing) {
+        delete board;
+    }
+    if (!empty) {
+        throw runtime_error("Restore needs a database without boards, use --db to pick a new file.");
+    }
+
+    // all or nothing, a bad entry rolls the whole restore back
+    Database::Batch batch(db);
+    for (uint32_t b = 0; b < snapshot.getBoardCount(); b++) {
+        const BoardEntry& entry = snapshot.getBoard(b);
+        Board board(string(snapshot.getTitle(entry)));
+        board.setId(entry.id);
+        db.insertBoard(board);
+        uint64_t count = snapshot.getTaskCount(entry);
+        for (uint64_t position = 0; position < count; position++) {
+            const TaskEntry& taskEntry = snapshot.getTask(entry, position);
+            if (taskEntry.stage > static_cast<uint8_t>(Stage::Done)) {
+                throw runtime_error(path + " is damaged, task " + to_string(taskEntry.id) + " has no stage.");
+            }
+            Task task(string(snapshot.getTitle(taskEntry)), board);
+            task.setId(taskEntry.id);
+            task.setDescription(string(snapshot.getDescription(taskEntry)));
+            task.setDifficulty(taskEntry.difficulty);
+            task.setStage(static_cast<Stage>(taskEntry.stage), true);
+            db.insertTask(task);
+        }
+    }
+    batch.commit();
+    output << "restored " << snapshot.getBoardCount() << " boards and " << snapshot.getHeader().taskCount
+        << " tasks from " << path << endl;
+}
+
+const Snapshot::Header& Snapshot::getHeader() {
+    return *this->header;
+}
+
+uint32_t Snapshot::getBoardCount() {
+    return this->header->boardCount;
+}
+
+const Snapshot::BoardEntry& Snapshot::getBoard(uint32_t index) {
+    if (index >= this->header->boardCount) {
+        throw runtime_error("Snapshot has no board " + to_string(index) + ".");
+    }
+    return this->boards[index];
+}
+
+uint64_t Snapshot::getTaskCount(const BoardEntry& board) {
+    uint64_t count = static_cast<uint64_t>(board.stageCounts[0]) + board.stageCounts[1] + board.stageCounts[2];
+    if (board.firstTask > this->header->taskCount || count > this->header->taskCount - board.firstTask) {
+        throw runtime_error("Snapshot is damaged, board " + to_string(board.id) + " points past the task table.");
+    }
+    return count;
+}
+
+// a board's task at a position in stage, id order
+const Snapshot::TaskEntry& Snapshot::getTask(const BoardEntry& board, uint64_t position) {
+    if (position >= getTaskCount(board)) {
+        throw runtime_error("Board " + to_string(board.id) + " has no task at " + to_string(position) + ".");
+    }
+    return this->tasks[board.firstTask + position];
+}
+
+string_view Snapshot::getTitle(const BoardEntry& board) {
+    return text(board.titleOffset, board.titleLength);
+}
+
+string_view Snapshot::getTitle(const TaskEntry& task) {
+    return text(task.titleOffset, task.titleLength);
+}
+
+string_view Snapshot::getDescription(const TaskEntry& task) {
+    return text(task.descriptionOffset, task.descriptionLength);
+}
+
+void Snapshot::map(const string& path) {
+#ifdef _WIN32
+    this->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (this->file == INVALID_HANDLE_VALUE) {
+        throw runtime_error("Can't open snapshot " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(this->file, &fileSize) || fileSize.QuadPart == 0) {
+        unmap();
+        throw runtime_error(path + " is not a kanban snapshot.");
+    }
+    this->size = static_cast<uint64_t>(fileSize.QuadPart);
+    this->mapping = CreateFileMappingA(this->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (this->mapping != nullptr) {
+        this->data = static_cast<const char*>(MapViewOfFile(this->mapping, FILE_MAP_READ, 0, 0, 0));
+    }
+#else
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw runtime_error("Can't open snapshot " + path);
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0) {
+        close(descriptor);
+        throw runtime_error(path + " is not a kanban snapshot.");
+    }
+    this->size = static_cast<uint64_t>(status.st_size);
+    // pages are read from disk as they are first touched, the mapping stays valid after close
+    void* mapped = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    this->data = (mapped == MAP_FAILED) ? nullptr : static_cast<const char*>(mapped);
+#endif
+    if (this->data == nullptr) {
+        unmap();
+        throw runtime_error("Can't map snapshot " + path);
+    }
+}
+
+void Snapshot::unmap() {
+#ifdef _WIN32
+    if (this->data != nullptr) {
+        UnmapViewOfFile(this->data);
+    }
+    if (this->mapping != nullptr) {
+        CloseHandle(this->mapping);
+    }
+    if (this->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(this->file);
+    }
+    this->mapping = nullptr;
+    this->file = INVALID_HANDLE_VALUE;
+#else
+    if (this->data != nullptr) {
+        munmap(const_cast<char*>(this->data), this->size);
+    }
+#endif
+    this->data = nullptr;
+}
+
+// a string from the heap, checked against the heap's end
+string_view Snapshot::text(uint64_t offset, uint32_t length) {
+    if (offset > this->header->stringsSize || length > this->header->stringsSize - offset) {
+        throw runtime_error("Snapshot is damaged, text points past the string heap.");
+    }
+    return string_view(this->strings + offset, length);
+}
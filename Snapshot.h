@@ -0,0 +1,98 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "Database.h"
+#include "Board.h"
+#include "Task.h"
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// read-only copy of every board and task in one binary file, opened by mapping it into memory.
+// layout: header, board table, task table, string heap. tables hold fixed size entries that
+// point into the heap, so reading a board or task is an array index and no parsing.
+// numbers are stored little-endian, the byte order of every platform the app builds for
+class Snapshot {
+public:
+    static const uint32_t VERSION = 1;
+
+    // start of the file
+    struct Header {
+        char magic[8]; // "KANBANSS"
+        uint32_t version;
+        uint32_t boardCount;
+        uint64_t taskCount;
+        uint64_t boardsOffset;
+        uint64_t tasksOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+        int64_t createdAt; // unix time
+    };
+
+    // one board, in title order. its tasks are taskCount entries from firstTask
+    struct BoardEntry {
+        int32_t id;
+        uint32_t titleLength;
+        uint64_t titleOffset;
+        uint64_t firstTask;
+        uint32_t stageCounts[3];
+        uint32_t totalDifficulty;
+    };
+
+    // one task, in board then stage, id order
+    struct TaskEntry {
+        int32_t id;
+        int32_t boardId;
+        uint64_t titleOffset;
+        uint64_t descriptionOffset;
+        uint32_t titleLength;
+        uint32_t descriptionLength;
+        uint8_t stage;
+        uint8_t difficulty;
+        uint8_t padding[6];
+    };
+
+    Snapshot(const string& path);
+    ~Snapshot();
+    // owns the file mapping, so copies are not allowed
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    static void write(Database& db, const string& path, ostream& output);
+    static void restore(const string& path, Database& db, ostream& output);
+    const Header& getHeader();
+    uint32_t getBoardCount();
+    const BoardEntry& getBoard(uint32_t index);
+    uint64_t getTaskCount(const BoardEntry& board);
+    const TaskEntry& getTask(const BoardEntry& board, uint64_t position);
+    string_view getTitle(const BoardEntry& board);
+    string_view getTitle(const TaskEntry& task);
+    string_view getDescription(const TaskEntry& task);
+
+private:
+    static const int WRITE_PAGE_SIZE = 1000; // tasks read from the database at a time
+
+    void map(const string& path);
+    void unmap();
+    string_view text(uint64_t offset, uint32_t length);
+
+    const char* data; // the mapped file
+    uint64_t size;
+    const Header* header;
+    const BoardEntry* boards;
+    const TaskEntry* tasks;
+    const char* strings;
+#ifdef _WIN32
+    void* file; // windows handles, kept until unmapped
+    void* mapping;
+#endif
+};
+
+#endif // SNAPSHOT_H
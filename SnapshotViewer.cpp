@@ -0,0 +1,240 @@
+#include "SnapshotViewer.h"
+
+using namespace std;
+
+SnapshotViewer::SnapshotViewer(Snapshot& snapshot, const string& path, bool offscreen) : snapshot(snapshot), screen(offscreen) {
+    this->running = true;
+    this->currScreen = "Boards";
+    this->boardIndex = 0;
+    this->selectedIndex = 0;
+    this->scrollTop = 0;
+    this->openTask = 0;
+    this->padL = string(10, ' ');
+
+    // the same frame as the app, with where the snapshot came from in place of the commands
+    const int screenWidth = 120;
+    string title = " Kanban Snapshot (read only) ";
+    string topPadding((screenWidth - title.length()) / 2, '=');
+    this->menuTop = topPadding + title + topPadding + "\n";
+    time_t created = static_cast<time_t>(snapshot.getHeader().createdAt);
+    char taken[32] = "";
+    strftime(taken, sizeof(taken), "%Y-%m-%d %H:%M", localtime(&created));
+    string info = "| " + path + " | taken " + taken + " | up/down: Select | enter: Open | b: Back | esc: Quit |";
+    string infoPadding((screenWidth - min<size_t>(info.length(), screenWidth)) / 2, ' ');
+    this->menuInfo = infoPadding + info + "\n";
+    string bottom = " (Press key to make selection) ";
+    string bottomPadding((screenWidth - bottom.length()) / 2, '=');
+    this->menuBottom = bottomPadding + bottom + bottomPadding + "=\n";
+}
+
+void SnapshotViewer::run() {
+    while (this->running) {
+        displayScreen();
+        handleKey(this->terminal.readKey());
+    }
+}
+
+void SnapshotViewer::displayScreen() {
+    ScreenBuffer& screen = this->screen;
+    screen.beginFrame();
+    screen.write(this->menuTop);
+    screen.write(this->menuInfo);
+    screen.write(this->menuBottom);
+    screen.write("\n");
+    int visibleRows = max(3, screen.getHeight() - screen.getLineCount() - 6); // list title, blank, footer, blank, prompt
+
+    if (this->currScreen == "Boards") {
+        screen.write(this->padL);
+        screen.write("| Boards |\n\n");
+        if (this->snapshot.getBoardCount() > 0) {
+            displayBoardList(visibleRows);
+        }
+        else {
+            screen.write(this->padL);
+            screen.write("[The snapshot has no boards]\n");
+        }
+    }
+    else if (this->currScreen == "Board View") {
+        screen.write(this->padL);
+        screen.write("| Board Name: ");
+        screen.write(this->snapshot.getTitle(this->snapshot.getBoard(this->boardIndex)));
+        screen.write(" |\n\n");
+        if (getItemCount() > 0) {
+            displayTaskList(visibleRows);
+        }
+        else {
+            screen.write(this->padL);
+            screen.write("[The board has no tasks]\n");
+        }
+    }
+    else if (this->currScreen == "Task View") {
+        displayTaskCard();
+    }
+    screen.write("\n");
+    screen.present();
+}
+
+void SnapshotViewer::displayBoardList(int visibleRows) {
+    // one row per board with its summary, lined up after the longest title on screen
+    long long totalRows = this->snapshot.getBoardCount();
+    long long firstRow = scrollToRow(this->selectedIndex, totalRows, visibleRows);
+    long long lastRow = min(totalRows, firstRow + visibleRows);
+    size_t titleWidth = 0;
+    for (long long row = firstRow; row < lastRow; row++) {
+        titleWidth = max(titleWidth, this->snapshot.getTitle(this->snapshot.getBoard(static_cast<uint32_t>(row))).length());
+    }
+    for (long long row = firstRow; row < lastRow; row++) {
+        const Snapshot::BoardEntry& board = this->snapshot.getBoard(static_cast<uint32_t>(row));
+        string& line = this->lineBuffer;
+        line.assign(this->snapshot.getTitle(board));
+        line.append(titleWidth - line.length() + 3, ' ');
+        line.append("To Do: ").append(to_string(board.stageCounts[0]));
+        line.append(" | In Progress: ").append(to_string(board.stageCounts[1]));
+        line.append(" | Done: ").append(to_string(board.stageCounts[2]));
+        line.append(" | Difficulty: ").append(to_string(board.totalDifficulty));
+        displayTitle(line, row == this->selectedIndex);
+    }
+    displayListPosition(totalRows, totalRows > visibleRows);
+}
+
+void SnapshotViewer::displayTaskList(int visibleRows) {
+    // one row per task in stage, id order, with its stage in front
+    const Snapshot::BoardEntry& board = this->snapshot.getBoard(this->boardIndex);
+    long long totalRows = getItemCount();
+    long long firstRow = scrollToRow(this->selectedIndex, totalRows, visibleRows);
+    long long lastRow = min(totalRows, firstRow + visibleRows);
+    for (long long row = firstRow; row < lastRow; row++) {
+        const Snapshot::TaskEntry& task = this->snapshot.getTask(board, static_cast<uint64_t>(row));
+        string& line = this->lineBuffer;
+        line.assign("[").append(Task::stageToString(static_cast<Stage>(min<int>(task.stage, 2)))).append("] ");
+        line.append(max<size_t>(line.length(), 14) - line.length(), ' ');
+        line.append(this->snapshot.getTitle(task));
+        displayTitle(line, row == this->selectedIndex);
+    }
+    displayListPosition(totalRows, totalRows > visibleRows);
+}
+
+void SnapshotViewer::displayTaskCard() {
+    const Snapshot::BoardEntry& board = this->snapshot.getBoard(this->boardIndex);
+    const Snapshot::TaskEntry& task = this->snapshot.getTask(board, static_cast<uint64_t>(this->openTask));
+    ScreenBuffer& screen = this->screen;
+    screen.write("\n");
+    screen.write(this->padL);
+    screen.write("Title: ");
+    screen.setColor(TextColor::Normal);
+    screen.write(this->snapshot.getTitle(task));
+    screen.write("\n");
+    screen.setColor(TextColor::Bright);
+    screen.write(this->padL);
+    screen.write("Description: \n");
+    screen.setColor(TextColor::Normal);
+    screen.writeWrapped(this->snapshot.getDescription(task), this->padL, 50);
+    screen.setColor(TextColor::Bright);
+    screen.write(this->padL);
+    screen.write("Stage: ");
+    screen.setColor(TextColor::Normal);
+    screen.write(Task::stageToString(static_cast<Stage>(min<int>(task.stage, 2))));
+    screen.write("\n");
+    screen.setColor(TextColor::Bright);
+    screen.write(this->padL);
+    screen.write("Rated Difficulty: ");
+    screen.setColor(TextColor::Normal);
+    screen.write(to_string(task.difficulty));
+    screen.write("\n");
+    screen.setColor(TextColor::Bright);
+}
+
+void SnapshotViewer::displayTitle(string_view title, bool selected) {
+    // print one list title, highlighted when selected
+    this->screen.setColor(selected ? TextColor::Highlight : TextColor::Bright);
+    this->screen.write(this->padL);
+    this->screen.write("* ");
+    this->screen.write(title);
+    this->screen.write("\n");
+    this->screen.setColor(TextColor::Bright);
+}
+
+void SnapshotViewer::displayListPosition(long long itemCount, bool clipped) {
+    // footer with the selected position, only when the list does not fit
+    if (clipped) {
+        this->screen.write(this->padL);
+        this->screen.write("(");
+        this->screen.write(to_string(this->selectedIndex + 1));
+        this->screen.write(" of ");
+        this->screen.write(to_string(itemCount));
+        this->screen.write(")\n");
+    }
+}
+
+long long SnapshotViewer::scrollToRow(long long row, long long totalRows, int visibleRows) {
+    // move the viewport just enough to keep the row visible, returns the first visible row
+    if (row < this->scrollTop) {
+        this->scrollTop = row;
+    }
+    else if (row >= this->scrollTop + visibleRows) {
+        this->scrollTop = row - visibleRows + 1;
+    }
+    this->scrollTop = max(0LL, min(this->scrollTop, totalRows - visibleRows));
+    return this->scrollTop;
+}
+
+void SnapshotViewer::handleKey(int key) {
+    switch (key) {
+    case Terminal::KEY_UP: moveSelector(-1); break;
+    case Terminal::KEY_DOWN: moveSelector(1); break;
+    case Terminal::KEY_ENTER:
+        if (this->currScreen == "Boards" && this->snapshot.getBoardCount() > 0) {
+            this->boardIndex = static_cast<uint32_t>(this->selectedIndex);
+            this->currScreen = "Board View";
+            this->selectedIndex = 0;
+            this->scrollTop = 0;
+        }
+        else if (this->currScreen == "Board View" && getItemCount() > 0) {
+            this->openTask = this->selectedIndex;
+            this->currScreen = "Task View";
+        }
+        break;
+    case 'b':
+        if (this->currScreen == "Task View") {
+            // back on the task that was open
+            this->currScreen = "Board View";
+            this->selectedIndex = this->openTask;
+        }
+        else if (this->currScreen == "Board View") {
+            this->currScreen = "Boards";
+            this->selectedIndex = this->boardIndex;
+            this->scrollTop = 0;
+        }
+        break;
+    case Terminal::KEY_CTRL_C:
+    case Terminal::KEY_ESC:
+        this->running = false;
+        break;
+    }
+}
+
+void SnapshotViewer::moveSelector(int direction) {
+    long long count = getItemCount();
+    if (count > 0) {
+        this->selectedIndex = max(0LL, min(count - 1, this->selectedIndex + direction));
+    }
+}
+
+// rows of the list on screen
+long long SnapshotViewer::getItemCount() {
+    if (this->currScreen == "Boards") {
+        return this->snapshot.getBoardCount();
+    }
+    if (this->currScreen == "Board View") {
+        return static_cast<long long>(this->snapshot.getTaskCount(this->snapshot.getBoard(this->boardIndex)));
+    }
+    return 0;
+}
+
+bool SnapshotViewer::isRunning() {
+    return this->running;
+}
+
+ScreenBuffer& SnapshotViewer::getScreen() {
+    return this->screen;
+}
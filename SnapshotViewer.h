@@ -0,0 +1,53 @@
+#ifndef SNAPSHOTVIEWER_H
+#define SNAPSHOTVIEWER_H
+
+#include "Snapshot.h"
+#include "Terminal.h"
+#include "ScreenBuffer.h"
+#include "Task.h"
+#include <iostream>
+#include <algorithm>
+#include <ctime>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// read-only browser for a snapshot. everything shown is read from the mapped file,
+// so it opens at once whatever the size and a frame allocates nothing
+class SnapshotViewer {
+public:
+    SnapshotViewer(Snapshot& snapshot, const string& path, bool offscreen = false);
+    void run();
+    void displayScreen();
+    void handleKey(int key);
+    bool isRunning();
+    ScreenBuffer& getScreen();
+
+private:
+    void displayBoardList(int visibleRows);
+    void displayTaskList(int visibleRows);
+    void displayTaskCard();
+    void displayTitle(string_view title, bool selected);
+    void displayListPosition(long long itemCount, bool clipped);
+    long long scrollToRow(long long row, long long totalRows, int visibleRows);
+    void moveSelector(int direction);
+    long long getItemCount();
+
+    Snapshot& snapshot;
+    Terminal terminal;
+    ScreenBuffer screen;
+    bool running;
+    string currScreen; // Boards, Board View or Task View, like the app
+    string menuTop; // centered lines, built once
+    string menuInfo;
+    string menuBottom;
+    string padL;
+    string lineBuffer; // list lines composed from several parts, reused between frames
+    uint32_t boardIndex; // open board
+    long long selectedIndex;
+    long long scrollTop; // first list row shown in the viewport
+    long long openTask; // task shown on the task view
+};
+
+#endif // SNAPSHOTVIEWER_H
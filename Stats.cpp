@@ -0,0 +1,126 @@
+#include "Stats.h"
+
+using namespace std;
+
+Stats::Histogram Stats::queries[QUERY_KINDS];
+atomic<long long> Stats::queryRows[QUERY_KINDS];
+Stats::Histogram Stats::frames;
+Stats::Histogram Stats::inputToFrame;
+atomic<long long> Stats::counters[COUNTERS];
+
+Stats::Histogram::Histogram() {
+    for (atomic<long long>& bucket : this->buckets) {
+        bucket = 0;
+    }
+    this->count = 0;
+    this->total = 0;
+    this->max = 0;
+}
+
+void Stats::Histogram::add(long long micros) {
+    // bucket of the highest set bit, 0 for values under 1 us
+    int bucket = 0;
+    while (bucket < BUCKETS - 1 && (micros >> bucket) > 0) {
+        bucket++;
+    }
+    this->buckets[bucket].fetch_add(1, memory_order_relaxed);
+    this->count.fetch_add(1, memory_order_relaxed);
+    this->total.fetch_add(micros, memory_order_relaxed);
+    long long largest = this->max.load(memory_order_relaxed);
+    while (micros > largest) {
+        // a failed exchange reloads largest, another thread may have raised it
+        if (this->max.compare_exchange_weak(largest, micros, memory_order_relaxed)) {
+            break;
+        }
+    }
+}
+
+long long Stats::Histogram::getCount() {
+    return this->count.load(memory_order_relaxed);
+}
+
+double Stats::Histogram::getMean() {
+    long long samples = getCount();
+    return (samples == 0) ? 0 : static_cast<double>(this->total.load(memory_order_relaxed)) / samples;
+}
+
+// upper bound of the bucket holding the percentile, never above the largest value seen
+long long Stats::Histogram::getPercentile(double fraction) {
+    long long samples = getCount();
+    if (samples == 0) {
+        return 0;
+    }
+    long long rank = static_cast<long long>(fraction * samples);
+    long long seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += this->buckets[bucket].load(memory_order_relaxed);
+        if (seen > rank) {
+            long long bound = (bucket == 0) ? 0 : (1LL << bucket) - 1;
+            return min(bound, getMax());
+        }
+    }
+    return getMax();
+}
+
+long long Stats::Histogram::getMax() {
+    return this->max.load(memory_order_relaxed);
+}
+
+void Stats::addQuery(Query query, long long micros, long long rows) {
+    int kind = static_cast<int>(query);
+    queries[kind].add(micros);
+    queryRows[kind].fetch_add(rows, memory_order_relaxed);
+}
+
+void Stats::addFrame(long long micros) {
+    frames.add(micros);
+}
+
+void Stats::addInputToFrame(long long micros) {
+    inputToFrame.add(micros);
+}
+
+void Stats::add(Counter counter, long long amount) {
+    counters[static_cast<int>(counter)].fetch_add(amount, memory_order_relaxed);
+}
+
+// kind of a statement from its sql, searches start with WITH and count as selects
+Stats::Query Stats::queryKind(const char* sql) {
+    while (*sql == ' ' || *sql == '\n' || *sql == '\t') {
+        sql++;
+    }
+    switch (*sql) {
+    case 'S': case 's': case 'W': case 'w': return Query::Select;
+    case 'I': case 'i': return Query::Insert;
+    case 'U': case 'u': return Query::Update;
+    case 'D': case 'd': return Query::Delete;
+    }
+    return Query::Other;
+}
+
+void Stats::report(ostream& output) {
+    static const char* queryNames[QUERY_KINDS] = { "select", "insert", "update", "delete", "other" };
+    output << left << setw(24) << "stats" << right << setw(10) << "count" << setw(10) << "mean us"
+        << setw(10) << "p50 us" << setw(10) << "p90 us" << setw(10) << "p99 us" << setw(10) << "max us"
+        << setw(12) << "rows" << "\n";
+    for (int kind = 0; kind < QUERY_KINDS; kind++) {
+        printHistogram(output, string("query ") + queryNames[kind], queries[kind]);
+        output << setw(12) << queryRows[kind].load(memory_order_relaxed) << "\n";
+    }
+    printHistogram(output, "frame render", frames);
+    output << "\n";
+    printHistogram(output, "input to frame", inputToFrame);
+    output << "\n";
+    output << "boards allocated " << counters[static_cast<int>(Counter::BoardsAllocated)].load(memory_order_relaxed)
+        << ", freed " << counters[static_cast<int>(Counter::BoardsFreed)].load(memory_order_relaxed) << "\n";
+    output << "tasks allocated " << counters[static_cast<int>(Counter::TasksAllocated)].load(memory_order_relaxed)
+        << ", freed " << counters[static_cast<int>(Counter::TasksFreed)].load(memory_order_relaxed) << "\n";
+    output << "(percentiles are the upper bound of a power of two bucket)" << endl;
+}
+
+void Stats::printHistogram(ostream& output, const string& name, Histogram& histogram) {
+    output << left << setw(24) << name << right << setw(10) << histogram.getCount()
+        << fixed << setprecision(1) << setw(10) << histogram.getMean() << defaultfloat
+        << setw(10) << histogram.getPercentile(0.5) << setw(10) << histogram.getPercentile(0.9)
+        << setw(10) << histogram.getPercentile(0.99) << setw(10) << histogram.getMax();
+}
@@ -0,0 +1,61 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+// session counters and latency histograms, shared by every thread and connection.
+// updates are relaxed atomic increments, cheap enough to leave on all the time
+class Stats {
+public:
+    // latencies in microseconds, counted in power of two buckets
+    class Histogram {
+    public:
+        Histogram();
+        void add(long long micros);
+        long long getCount();
+        double getMean();
+        long long getPercentile(double fraction);
+        long long getMax();
+
+    private:
+        static const int BUCKETS = 40; // bucket i holds values below 2^i, the last one everything above
+
+        atomic<long long> buckets[BUCKETS];
+        atomic<long long> count;
+        atomic<long long> total;
+        atomic<long long> max;
+    };
+
+    // statements by their first keyword
+    enum class Query { Select, Insert, Update, Delete, Other };
+
+    // objects made and dropped when boards and task windows are replaced
+    enum class Counter { BoardsAllocated, BoardsFreed, TasksAllocated, TasksFreed };
+
+    static void addQuery(Query query, long long micros, long long rows);
+    static void addFrame(long long micros);
+    static void addInputToFrame(long long micros);
+    static void add(Counter counter, long long amount);
+    static Query queryKind(const char* sql);
+    static void report(ostream& output);
+
+private:
+    static const int QUERY_KINDS = 5;
+    static const int COUNTERS = 4;
+
+    static void printHistogram(ostream& output, const string& name, Histogram& histogram);
+
+    static Histogram queries[QUERY_KINDS];
+    static atomic<long long> queryRows[QUERY_KINDS]; // rows read by selects, rows changed by writes
+    static Histogram frames; // displayScreen, from building the frame to drawing it
+    static Histogram inputToFrame; // key press to the frame that shows its effect
+    static atomic<long long> counters[COUNTERS];
+};
+
+#endif // STATS_H
@@ -1,9 +1,10 @@
 #include "Task.h"
+#include "Board.h"
 
 using namespace std;
 
-Task::Task(string title, Board& board) : title(title) {
-    if (title.empty()) {
+Task::Task(string title, Board& board) : title(move(title)) {
+    if (this->title.empty()) {
         throw invalid_argument("Title can't be empty.");
     }
     this->id = 0;
@@ -12,29 +13,25 @@ Task::Task(string title, Board& board) : title(title) {
     this->boardId = board.getId();
 }
 
-Task::~Task() {
-    // no lists or pointers to deallocate
-}
-
 void Task::setId(const int id) {
     this->id = id;
 }
 
-void Task::setTitle(const string newTitle) {
+void Task::setTitle(string newTitle) {
     if (newTitle.empty()) {
         throw invalid_argument("Title can't be empty.");
     }
     else if (newTitle.length() > 50) { // char limit on title
         throw invalid_argument("Title can't exceed 50 characters.");
     }
-    this->title = newTitle;
+    this->title = move(newTitle);
 }
 
-void Task::setDescription(const string newDesc) {
+void Task::setDescription(string newDesc) {
     if (newDesc.length() > 500) { // char limit on title
         throw invalid_argument("Description can't exceed 500 characters.");
     }
-    this->description = newDesc;
+    this->description = move(newDesc);
 }
 
 void Task::setStage(const Stage newStage, const bool loading) {
@@ -70,15 +67,25 @@ void Task::setBoardId(const int boardId) {
     this->boardId = boardId;
 }
 
+// re-check the setter rules, for tasks about to be saved in a batch.
+// runs the setters on the task's own values so the rules and messages stay the same
+void Task::validate() {
+    setTitle(this->title);
+    setDescription(this->description);
+    setDifficulty(this->difficultyRating);
+    setStage(this->stage, true);
+}
+
 int Task::getId() {
     return this->id;
 }
 
-string Task::getTitle() {
+// references stay valid until the task is changed or moved
+const string& Task::getTitle() {
     return this->title;
 }
 
-string Task::getDescription() {
+const string& Task::getDescription() {
     return this->description;
 }
 
@@ -95,7 +102,7 @@ int Task::getBoardId() {
 }
 
 // helper convert methods for dealing with Stages as strings
-string Task::stageToString(Stage stage) {
+string_view Task::stageToString(Stage stage) {
     switch (stage) {
     case Stage::ToDo: return "To Do";
     case Stage::InProgress: return "In Progress";
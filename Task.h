@@ -1,11 +1,11 @@
 #ifndef TASK_H
 #define TASK_H
 
-#include "Board.h"
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <list>
 
 using namespace std;
@@ -21,20 +21,20 @@ enum class Stage {
 class Task {
 public:
     Task(string title, Board& board);
-    ~Task();
     void setId(const int id);
-    void setTitle(const string newTitle);
-    void setDescription(const string newDesc);
+    void setTitle(string newTitle);
+    void setDescription(string newDesc);
     void setStage(const Stage newStage, const bool loading);
     void setDifficulty(const int rating);
     void setBoardId(const int boardId);
+    void validate();
     int getId();
-    string getTitle();
-    string getDescription();
+    const string& getTitle();
+    const string& getDescription();
     Stage getStage();
     int getDifficulty();
     int getBoardId();
-    static string stageToString(Stage stage);
+    static string_view stageToString(Stage stage);
     static Stage stringToStage(const string& stageStr);
 
 private:
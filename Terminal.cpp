@@ -0,0 +1,171 @@
+#include "Terminal.h"
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+volatile sig_atomic_t Terminal::interrupted = 0;
+
+Terminal::Terminal() {
+    this->rawMode = false;
+    this->keyTime = chrono::steady_clock::now();
+}
+
+Terminal::~Terminal() {
+    // leave the console the way it was found
+    setRawMode(false);
+}
+
+void Terminal::setRawMode(const bool enabled) {
+    if (enabled) {
+        catchSignals();
+    }
+#ifndef _WIN32
+    // windows reads single keys with _getch, no mode switch needed
+    if (enabled == this->rawMode || !isatty(STDIN_FILENO)) {
+        return;
+    }
+    if (enabled) {
+        tcgetattr(STDIN_FILENO, &this->savedMode);
+        struct termios raw = this->savedMode;
+        // no line buffering or echo, read returns after every byte.
+        // ctrl+c arrives as a key, so it quits through the same path as esc
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+        raw.c_cc[VMIN] = 1;
+        raw.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    }
+    else {
+        tcsetattr(STDIN_FILENO, TCSANOW, &this->savedMode);
+    }
+#endif
+    this->rawMode = enabled;
+}
+
+int Terminal::readKey() {
+    // blocks until a key is pressed, returns the key code
+    setRawMode(true);
+    cout.flush();
+    if (interrupted) {
+        return KEY_CTRL_C;
+    }
+
+#ifdef _WIN32
+    // _getch blocks until a key is available, ctrl+c comes back as its key code
+    int ch = _getch();
+    this->keyTime = chrono::steady_clock::now();
+    switch (ch) {
+    case 0:
+    case 224: // arrow and function keys send a prefix first
+        ch = _getch();
+        switch (ch) {
+        case 72: return KEY_UP;
+        case 80: return KEY_DOWN;
+        }
+        return KEY_NONE;
+    case 13: return KEY_ENTER;
+    case 8: return KEY_BACKSPACE;
+    }
+    return ch;
+#else
+    // sleep in poll until stdin has data, so an idle app uses no cpu
+    waitForInput(-1);
+    this->keyTime = chrono::steady_clock::now();
+    if (interrupted) {
+        // a stop signal, or ctrl+c typed at a prompt
+        return KEY_CTRL_C;
+    }
+    int ch = readByte();
+    switch (ch) {
+    case -1:
+        throw runtime_error("Lost connection to keyboard input.");
+    case 27: return decodeEscape();
+    case '\r':
+    case '\n': return KEY_ENTER;
+    case 8:
+    case 127: return KEY_BACKSPACE;
+    }
+    return ch;
+#endif
+}
+
+chrono::steady_clock::time_point Terminal::getKeyTime() {
+    // when the last key reached the program
+    return this->keyTime;
+}
+
+bool Terminal::wasInterrupted() {
+    return interrupted != 0;
+}
+
+void Terminal::onSignal(int) {
+    // only sets the flag, the next key read turns it into ctrl+c
+    interrupted = 1;
+}
+
+void Terminal::catchSignals() {
+    // ctrl+c at a prompt and stop signals quit like esc, so queued edits are saved and the
+    // console restored. only the interactive app catches them, commands stop as usual
+    static bool caught = false;
+    if (caught) {
+        return;
+    }
+    caught = true;
+#ifdef _WIN32
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+#else
+    // no SA_RESTART, so a read waiting at a prompt returns and the key loop sees the flag
+    struct sigaction action = {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGHUP, &action, nullptr);
+#endif
+}
+
+#ifndef _WIN32
+bool Terminal::waitForInput(int timeoutMs) {
+    // true when stdin has data within the timeout, -1 waits forever
+    struct pollfd input = { STDIN_FILENO, POLLIN, 0 };
+    int ready;
+    do {
+        ready = poll(&input, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR && !interrupted);
+    return ready > 0;
+}
+
+int Terminal::readByte() {
+    unsigned char ch;
+    ssize_t count;
+    do {
+        count = read(STDIN_FILENO, &ch, 1);
+    } while (count < 0 && errno == EINTR);
+    return (count == 1) ? ch : -1;
+}
+
+int Terminal::decodeEscape() {
+    // arrow keys arrive as ESC [ A or ESC O A. a lone ESC has nothing following it
+    if (!waitForInput(30)) {
+        return KEY_ESC;
+    }
+    int introducer = readByte();
+    if (introducer != '[' && introducer != 'O') {
+        return KEY_NONE;
+    }
+    // read up to the final byte of the sequence, modifiers like 1;5 come before it
+    int ch = readByte();
+    while (ch != -1 && (ch < 0x40 || ch > 0x7e)) {
+        ch = readByte();
+    }
+    switch (ch) {
+    case 'A': return KEY_UP;
+    case 'B': return KEY_DOWN;
+    }
+    return KEY_NONE;
+}
+#endif
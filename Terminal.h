@@ -0,0 +1,61 @@
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#ifdef _WIN32
+// exclude parts of <windows.h> causing build errors
+#define WIN32_LEAN_AND_MEAN
+#define RPC_NO_WINDOWS_H
+#include <windows.h>
+#include <conio.h>
+#else
+#include <termios.h>
+#endif
+
+#include <iostream>
+#include <stdexcept>
+#include <cstdlib>
+#include <cerrno>
+#include <csignal>
+#include <chrono>
+
+using namespace std;
+
+class Terminal {
+public:
+    // key codes returned by readKey. other keys are returned as their character
+    static constexpr int KEY_NONE = 0;
+    static constexpr int KEY_CTRL_C = 3; // also returned after a stop signal
+    static constexpr int KEY_BACKSPACE = 8;
+    static constexpr int KEY_CTRL_T = 20;
+    static constexpr int KEY_ENTER = 13;
+    static constexpr int KEY_ESC = 27;
+    static constexpr int KEY_UP = 1000;
+    static constexpr int KEY_DOWN = 1001;
+
+    Terminal();
+    ~Terminal();
+    // terminal handles console state, so copies are not allowed
+    Terminal(const Terminal&) = delete;
+    Terminal& operator=(const Terminal&) = delete;
+    void setRawMode(const bool enabled);
+    int readKey();
+    chrono::steady_clock::time_point getKeyTime();
+    static bool wasInterrupted();
+
+private:
+    static void onSignal(int signal);
+    static void catchSignals();
+
+    static volatile sig_atomic_t interrupted; // ctrl+c at a prompt or a stop signal, set by onSignal
+#ifndef _WIN32
+    bool waitForInput(int timeoutMs);
+    int readByte();
+    int decodeEscape();
+
+    struct termios savedMode;
+#endif
+    bool rawMode;
+    chrono::steady_clock::time_point keyTime;
+};
+
+#endif // TERMINAL_H
@@ -0,0 +1,97 @@
+#include "ThreadPool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount < 1) {
+        throw invalid_argument("A thread pool needs at least one thread.");
+    }
+    this->job = nullptr;
+    this->jobCount = 0;
+    this->nextJob = 0;
+    this->runNumber = 0;
+    this->busyCount = 0;
+    this->stopping = false;
+    for (int i = 0; i < threadCount; i++) {
+        this->workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(this->runMutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (thread& worker : this->workers) {
+        worker.join();
+    }
+}
+
+// run job(0) to job(jobCount - 1) on the workers and wait for all of them. one run at a time,
+// a job that throws stops the workers taking more and the exception is rethrown here
+void ThreadPool::run(size_t jobCount, const function<void(size_t)>& job) {
+    if (jobCount == 0) {
+        return;
+    }
+    unique_lock<mutex> lock(this->runMutex);
+    this->job = &job;
+    this->jobCount = jobCount;
+    this->nextJob = 0;
+    this->error = nullptr;
+    this->busyCount = static_cast<int>(this->workers.size());
+    this->runNumber++;
+    this->wake.notify_all();
+    this->finished.wait(lock, [this]() { return this->busyCount == 0; });
+    this->job = nullptr;
+    if (this->error) {
+        rethrow_exception(this->error);
+    }
+}
+
+int ThreadPool::getThreadCount() {
+    return static_cast<int>(this->workers.size());
+}
+
+// one thread per core, the standard library may not know how many there are
+int ThreadPool::defaultThreadCount() {
+    return max(1, static_cast<int>(thread::hardware_concurrency()));
+}
+
+void ThreadPool::work() {
+    Trace::nameThread("pool worker"); // the trace keeps the name, it has to outlive the thread
+    long long lastRun = 0;
+    while (true) {
+        const function<void(size_t)>* job;
+        size_t jobCount;
+        {
+            unique_lock<mutex> lock(this->runMutex);
+            this->wake.wait(lock, [this, lastRun]() { return this->stopping || this->runNumber != lastRun; });
+            if (this->stopping) {
+                return;
+            }
+            lastRun = this->runNumber;
+            job = this->job;
+            jobCount = this->jobCount;
+        }
+
+        for (size_t index = this->nextJob++; index < jobCount; index = this->nextJob++) {
+            try {
+                (*job)(index);
+            }
+            catch (...) {
+                lock_guard<mutex> lock(this->runMutex);
+                if (!this->error) {
+                    this->error = current_exception();
+                }
+                this->nextJob = jobCount; // the others stop after their current job
+            }
+        }
+
+        {
+            lock_guard<mutex> lock(this->runMutex);
+            this->busyCount--;
+        }
+        this->finished.notify_one();
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include "Trace.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+// worker threads that stay up between runs. a run hands out numbered jobs, each worker takes
+// the next one until none are left, and the caller waits for the last one to finish
+class ThreadPool {
+public:
+    ThreadPool(int threadCount);
+    ~ThreadPool();
+    // owns running threads, so copies are not allowed
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    void run(size_t jobCount, const function<void(size_t)>& job);
+    int getThreadCount();
+    static int defaultThreadCount();
+
+private:
+    void work();
+
+    mutex runMutex;
+    condition_variable wake; // workers wait here for a run
+    condition_variable finished; // run waits here for the workers
+    const function<void(size_t)>* job; // the run's job, set while it lasts
+    size_t jobCount;
+    atomic<size_t> nextJob; // taken without the lock
+    long long runNumber; // workers join each run once
+    int busyCount; // workers still in the current run
+    exception_ptr error; // first job that threw, rethrown by run
+    bool stopping;
+    vector<thread> workers; // started last, after everything they read is set up
+};
+
+#endif // THREADPOOL_H
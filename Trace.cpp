@@ -0,0 +1,107 @@
+#include "Trace.h"
+
+using namespace std;
+
+atomic<bool> Trace::enabled(false);
+mutex Trace::eventsMutex;
+vector<Trace::Event> Trace::events;
+chrono::steady_clock::time_point Trace::origin;
+atomic<int> Trace::threadCount(0);
+
+Trace::Trace(const string& path) : path(path) {
+    if (path.empty()) {
+        return;
+    }
+    // fail before the session rather than losing the trace at the end
+    ofstream file(path);
+    if (!file) {
+        throw runtime_error("Can't write trace file " + path);
+    }
+    origin = chrono::steady_clock::now();
+    enabled = true;
+    nameThread("ui");
+}
+
+Trace::~Trace() {
+    if (this->path.empty()) {
+        return;
+    }
+    enabled = false;
+    lock_guard<mutex> lock(eventsMutex);
+    ofstream file(this->path);
+    if (!file) {
+        cerr << "Can't write trace file " << this->path << endl;
+        return;
+    }
+    // complete events, times in microseconds since the trace started
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    for (size_t i = 0; i < events.size(); i++) {
+        Event& event = events[i];
+        if (event.duration < 0) {
+            file << "{\"ph\": \"M\", \"pid\": 1, \"tid\": " << event.thread << ", \"name\": \"thread_name\", \"args\": {\"name\": ";
+            writeString(file, event.name);
+            file << "}}";
+        }
+        else {
+            double start = chrono::duration<double, micro>(event.start - origin).count();
+            file << "{\"ph\": \"X\", \"pid\": 1, \"tid\": " << event.thread << ", \"name\": ";
+            writeString(file, event.name);
+            file << fixed << ", \"ts\": " << setprecision(3) << start << ", \"dur\": " << event.duration / 1000.0 << defaultfloat;
+            if (!event.detail.empty()) {
+                file << ", \"args\": {\"detail\": ";
+                writeString(file, event.detail);
+                file << "}";
+            }
+            file << "}";
+        }
+        file << ((i + 1 < events.size()) ? ",\n" : "\n");
+    }
+    file << "]}\n";
+    events.clear();
+}
+
+// keep a finished span, from any thread
+void Trace::complete(const char* name, chrono::steady_clock::time_point start,
+    chrono::steady_clock::time_point end, string_view detail) {
+    if (!isEnabled()) {
+        return;
+    }
+    long long duration = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+    int thread = threadNumber();
+    lock_guard<mutex> lock(eventsMutex);
+    events.push_back({ name, string(detail), start, duration, thread });
+}
+
+// label the calling thread in the trace viewer
+void Trace::nameThread(const char* name) {
+    if (!isEnabled()) {
+        return;
+    }
+    int thread = threadNumber();
+    lock_guard<mutex> lock(eventsMutex);
+    events.push_back({ name, "", origin, -1, thread });
+}
+
+// small stable number for the calling thread, the viewer draws one row per number
+int Trace::threadNumber() {
+    thread_local int number = ++threadCount;
+    return number;
+}
+
+void Trace::writeString(ostream& output, string_view text) {
+    // json string with quotes, backslashes and control characters escaped
+    static const char* hex = "0123456789abcdef";
+    output << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            output << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20) {
+            output << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+        }
+        else {
+            output << c;
+        }
+    }
+    output << '"';
+}
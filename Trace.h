@@ -0,0 +1,82 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// records timed spans from every thread and writes them as a chrome trace (json), which
+// chrome://tracing and ui.perfetto.dev open. off unless a trace file is given, then a span
+// costs one relaxed load of the enabled flag
+class Trace {
+public:
+    // times the enclosing scope, recorded when it ends
+    class Span {
+    public:
+        Span(const char* name, string_view detail = string_view()) : name(name) {
+            this->active = Trace::isEnabled();
+            if (this->active) {
+                this->detail.assign(detail);
+                this->start = chrono::steady_clock::now();
+            }
+        }
+        ~Span() {
+            if (this->active) {
+                Trace::complete(this->name, this->start, chrono::steady_clock::now(), this->detail);
+            }
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;
+        bool active;
+        string detail; // shown as the span's argument, only copied while tracing
+        chrono::steady_clock::time_point start;
+    };
+
+    // tracing runs while this lives, the file is written when it is destroyed.
+    // an empty path leaves tracing off
+    Trace(const string& path);
+    ~Trace();
+    // owns the process wide trace, so copies are not allowed
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+    static bool isEnabled() {
+        return enabled.load(memory_order_relaxed);
+    }
+    static void complete(const char* name, chrono::steady_clock::time_point start,
+        chrono::steady_clock::time_point end, string_view detail);
+    static void nameThread(const char* name);
+
+private:
+    // one finished span, or a thread name when duration is negative
+    struct Event {
+        const char* name;
+        string detail;
+        chrono::steady_clock::time_point start;
+        long long duration; // nanoseconds
+        int thread;
+    };
+
+    static int threadNumber();
+    static void writeString(ostream& output, string_view text);
+
+    string path;
+    static atomic<bool> enabled;
+    static mutex eventsMutex;
+    static vector<Event> events; // guarded by eventsMutex
+    static chrono::steady_clock::time_point origin; // time 0 of the trace
+    static atomic<int> threadCount;
+};
+
+#endif // TRACE_H
@@ -2,22 +2,42 @@
 
 using namespace std;
 
-UI::UI(Database& db) : db(db) {
+UI::UI(Database& db, bool offscreen) : db(db), screen(offscreen) {
     this->selectedIndex = 0;
     this->activeBoardId = 0;
     this->activeTaskId = 0;
+    this->scrollTop = 0;
+    this->running = true;
+    this->recorder = nullptr;
+    this->replaying = nullptr;
+    this->writer = nullptr;
+    this->prefetcher = nullptr;
+    this->lastKeyLatency = 0;
+    this->inputPending = false;
     this->currScreen = "Boards";
     this->screenMenus = {
-        {"Boards", "| up/down: Select | enter: Open Board | c: Create Board | d: Delete Board | esc: Quit |"},
+        {"Boards", "| up/down: Select | enter: Open Board | c: Create Board | d: Delete Board | /: Search | esc: Quit |"},
         {"Board View", "| up/down: Select | enter: Open Task | c: Create Task | d: Delete Task | t: Edit Board Title | b: Back | esc: Quit |"},
-        {"Task View", " | t: Edit Title | d: Edit Description | s: Edit Stage | r: Edit Difficulty Rating | b: Back | esc: Quit |"}
+        {"Task View", " | t: Edit Title | d: Edit Description | s: Edit Stage | r: Edit Difficulty Rating | b: Back | esc: Quit |"},
+        {"Search", "| type: Search All Tasks | up/down: Select | enter: Open Task | esc: Back |"}
     };
     this->screenWidth = 120; // length of the longest command menu
     string leftPadding(10, ' ');
     string headerPadding(30, '=');
     this->padL = leftPadding;
     this->padHeader = headerPadding;
-    setTextColor(TEXT_WHITE);
+
+    // the menu lines never change, center them once instead of every frame
+    string menuTop = " Kanban Board ";
+    string topPadding((this->screenWidth - menuTop.length()) / 2, '=');
+    this->menuTop = topPadding + menuTop + topPadding + "\n";
+    for (auto& menu : this->screenMenus) {
+        string menuPadding((this->screenWidth - menu.second.length()) / 2, ' ');
+        menu.second = menuPadding + menu.second + menuPadding + "\n";
+    }
+    string menuBottom = " (Press key to make selection) ";
+    string bottomPadding((this->screenWidth - menuBottom.length()) / 2, '=');
+    this->menuBottom = bottomPadding + menuBottom + bottomPadding + "=\n";
 }
 
 UI::~UI() {
@@ -26,12 +46,12 @@ UI::~UI() {
         delete board;
     }
     this->loadedBoards.clear();
+    this->boardIndex.clear();
 }
 
-void UI::setTextColor(const WORD color) {
-    // set the console text color
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    SetConsoleTextAttribute(hConsole, color);
+void UI::setTextColor(const TextColor color) {
+    // set the text color for what is written to the frame next
+    this->screen.setColor(color);
 }
 
 void UI::setSelectIndex(const int index) {
@@ -39,6 +59,7 @@ void UI::setSelectIndex(const int index) {
 }
 
 void UI::displayScreen() {
+    Trace::Span span("frame");
     /* The following code outputs a menu like this, but always centered:
     '=================================== Kanban Board ====================================
     '| up/down: Navigate | enter: Select | c: Create Board | d: Delete Board | esc: Quit |
@@ -49,197 +70,340 @@ void UI::displayScreen() {
     '     * Item two
     */
 
-    system("cls"); // clear the screen between each refresh
-    // top menu
-    // center the top title
-    string menuTop = " Kanban Board ";
-    string topPadding((this->screenWidth - menuTop.length()) / 2, '=');
-    // center the current menu
-    string menu = this->screenMenus[this->currScreen];
-    string menuPadding((this->screenWidth - menu.length()) / 2, ' ');
-    // center menu bottom
-    string menuBottom = " (Press key to make selection) ";
-    string bottomPadding((this->screenWidth - menuBottom.length()) / 2, '=');
+    auto frameStart = chrono::steady_clock::now();
+
+    // report saves that failed in the background since the last frame
+    if (this->writer != nullptr) {
+        string failed = this->writer->takeError();
+        if (!failed.empty()) {
+            addAlert("Saving failed: " + failed);
+        }
+    }
 
+    // build the frame in memory, present() then draws only what changed.
+    // text is written straight from the model, so a frame allocates nothing once the
+    // frame's lines have grown to size
+    ScreenBuffer& screen = this->screen;
+    screen.beginFrame();
     // output centered menu
-    cout << topPadding << menuTop << topPadding << endl;
-    cout << menuPadding << menu << menuPadding << endl;
-    cout << bottomPadding << menuBottom << bottomPadding << "=" << endl;
-    cout << endl;
+    screen.write(this->menuTop);
+    screen.write(this->screenMenus.find(this->currScreen)->second);
+    screen.write(this->menuBottom);
+    screen.write("\n");
 
     // the following code displays a selectable list of board or task titles
-    map<string, list<string>> titles;
+    // rows left for the list after the menu, alerts, footer and prompt line
+    int alertLines = this->userAlerts.empty() ? 0 : static_cast<int>(this->userAlerts.size()) + 1;
+    int reservedLines = screen.getLineCount() + 2 + alertLines + 3; // list title, blank, alerts, footer, blank, prompt
+    int visibleRows = max(3, screen.getHeight() - reservedLines);
+
     if (this->currScreen == "Boards") {
         // display title of board list view
-        cout << this->padL << "| Boards |" << endl << endl;
+        screen.write(this->padL);
+        screen.write("| Boards |\n\n");
 
         // display list of boards
         if (this->loadedBoards.size() > 0) {
-            for (Board* board : this->loadedBoards) {
-                titles["Board"].push_back(board->getTitle());
-            }
+            displayBoardList(visibleRows);
         }
         else {
-            cout << this->padL << "[Create first board with 'c' command]" << endl;;
+            screen.write(this->padL);
+            screen.write("[Create first board with 'c' command]\n");
         }
-        displayTitles(titles);
     }
     else if (this->currScreen == "Board View" && this->activeBoardId != 0) {
         // display title of board view, ie the name of the board
-        string boardTitle = getBoardById(this->activeBoardId)->getTitle();
-        cout << this->padL << "| Board Name: " << boardTitle << " |" << endl << endl;
+        Board* activeBoard = getBoardById(this->activeBoardId);
+        screen.write(this->padL);
+        screen.write("| Board Name: ");
+        screen.write(activeBoard->getTitle());
+        screen.write(" |\n\n");
 
         // display list of tasks for active board
-        list<Task*>& tasks = getBoardById(this->activeBoardId)->getTasks();
-        if (tasks.size() > 0) {
-            // add each stage with empty list so each gets displayed
-            // prefixed numbers keep sorting correct in a map
-            titles["1. To Do"] = list<string>();
-            titles["2. In Progress"] = list<string>();
-            titles["3. Done"] = list<string>();
-
-            for (Task* task : tasks) {
-                // add task to each stage list
-                switch (task->getStage()) {
-                case Stage::ToDo:
-                    titles["1. To Do"].push_back(task->getTitle());
-                    break;
-                case Stage::InProgress:
-                    titles["2. In Progress"].push_back(task->getTitle());
-                    break;
-                case Stage::Done:
-                    titles["3. Done"].push_back(task->getTitle());
-                    break;
-                }
-            }
+        if (activeBoard->getTaskCount() > 0) {
+            // make sure the tasks around the selection are loaded before drawing them
+            loadTasksNear(this->selectedIndex, max(TASK_PAGE_SIZE / 2, visibleRows));
+            displayTaskList(activeBoard, visibleRows);
         }
         else {
-            cout << "    ======= To Do =======" << this->padHeader << "\n" << endl;
-            cout << "\n    ======= In Progress =" << this->padHeader << "\n" << endl;
-            cout << "\n    ======= Done ========" << this->padHeader << "\n" << endl;
-            cout << endl;
-            cout << this->padL << "[Create first task with 'c' command]" << endl;;
+            screen.write("    ======= To Do =======");
+            screen.write(this->padHeader);
+            screen.write("\n\n\n    ======= In Progress =");
+            screen.write(this->padHeader);
+            screen.write("\n\n\n    ======= Done ========");
+            screen.write(this->padHeader);
+            screen.write("\n\n\n");
+            screen.write(this->padL);
+            screen.write("[Create first task with 'c' command]\n");
         }
-        displayTitles(titles);
     }
     else if (this->currScreen == "Task View" && this->activeBoardId != 0 && this->activeTaskId != 0) {
         // display selected task info
         Task* taskPtr = getBoardById(this->activeBoardId)->getTaskById(this->activeTaskId);
         displayTaskCard(taskPtr);
     }
+    else if (this->currScreen == "Search") {
+        screen.write(this->padL);
+        screen.write("| Search: ");
+        screen.write(this->searchText);
+        screen.write(" |\n\n");
+
+        if (this->searchResults.size() > 0) {
+            displaySearchResults(visibleRows);
+        }
+        else if (this->searchText.empty()) {
+            screen.write(this->padL);
+            screen.write("[Type words from a task title or description]\n");
+        }
+        else {
+            screen.write(this->padL);
+            screen.write("[No tasks match]\n");
+        }
+    }
 
     // Print any Alert messages to the user from the last loop
     if (this->userAlerts.size() > 0) {
-        cout << endl;
+        screen.write("\n");
         for (const string& alert : this->userAlerts) {
-            cout << this->padL << alert << endl;
+            screen.write(this->padL);
+            screen.write(alert);
+            screen.write("\n");
         }
         this->userAlerts.clear();
     }
 
-    cout << endl;
+    screen.write("\n");
+    screen.present();
+
+    auto presented = chrono::steady_clock::now();
+    Stats::addFrame(chrono::duration_cast<chrono::microseconds>(presented - frameStart).count());
+    if (this->inputPending) {
+        // the first frame after a key shows its effect
+        Stats::addInputToFrame(chrono::duration_cast<chrono::microseconds>(presented - this->inputTime).count());
+        if (Trace::isEnabled()) {
+            Trace::complete("key to frame", this->inputTime, presented, "");
+        }
+        this->inputPending = false;
+    }
 }
 
-void UI::displayTitles(map<string, list<string>>& titles) {
-    // display titles with selected title highlighted and stage name titles for tasks
-    bool shownToDo = false;
-    bool shownInProgress = false;
-    bool shownDone = false;
+void UI::displayBoardList(int visibleRows) {
+    // one row per board, only the rows inside the viewport are formatted
+    int totalRows = static_cast<int>(this->loadedBoards.size());
+    int firstRow = scrollToRow(this->selectedIndex, totalRows, visibleRows);
+    int lastRow = min(totalRows, firstRow + visibleRows);
 
-    int index = 0;
-    for (const auto& [key, value] : titles) { // loop map keys
-        // display stages once per presorted group of tasks with the stage
-        if (key == "1. To Do" && !shownToDo) {
-            cout << "    ======= To Do =======" << this->padHeader << "\n" << endl;
-            shownToDo = true;
+    // line the summaries up after the longest title on screen
+    size_t titleWidth = 0;
+    for (int row = firstRow; row < lastRow; row++) {
+        titleWidth = max(titleWidth, this->loadedBoards[row]->getTitle().length());
+    }
+    for (int row = firstRow; row < lastRow; row++) {
+        Board* board = this->loadedBoards[row];
+        // composed in a reused string, the counts are short enough to never allocate
+        string& line = this->lineBuffer;
+        line.assign(board->getTitle());
+        line.append(titleWidth - line.length() + 3, ' ');
+        line.append("To Do: ").append(to_string(board->getStageCount(Stage::ToDo)));
+        line.append(" | In Progress: ").append(to_string(board->getStageCount(Stage::InProgress)));
+        line.append(" | Done: ").append(to_string(board->getStageCount(Stage::Done)));
+        line.append(" | Difficulty: ").append(to_string(board->getTotalDifficulty()));
+        displayTitle(line, row == this->selectedIndex);
+    }
+    displayListPosition(totalRows, totalRows > visibleRows);
+}
+
+void UI::displayTaskList(Board* board, int visibleRows) {
+    /* rows of the task list, a header for every stage even when empty:
+    '    ======= To Do ======= (row 0)
+    '
+    '          * task         (first task row of the stage)
+    '
+    '    ======= In Progress =
+    '    ...
+    */
+    static const char* stageHeaders[3] = {
+        "    ======= To Do =======",
+        "    ======= In Progress =",
+        "    ======= Done ========"
+    };
+    // where each stage's tasks start, in the task list and in rows
+    int stageCounts[3];
+    int firstTask[3];
+    int firstTaskRow[3];
+    for (int stage = 0; stage < 3; stage++) {
+        stageCounts[stage] = board->getStageCount(static_cast<Stage>(stage));
+        firstTask[stage] = (stage == 0) ? 0 : firstTask[stage - 1] + stageCounts[stage - 1];
+        firstTaskRow[stage] = (stage == 0) ? 2 : firstTaskRow[stage - 1] + stageCounts[stage - 1] + 3;
+    }
+    int totalRows = firstTaskRow[2] + stageCounts[2];
+
+    // row of the selected task
+    int selectedStage = 0;
+    while (selectedStage < 2 && this->selectedIndex >= firstTask[selectedStage + 1]) {
+        selectedStage++;
+    }
+    int selectedRow = firstTaskRow[selectedStage] + (this->selectedIndex - firstTask[selectedStage]);
+
+    int firstRow = scrollToRow(selectedRow, totalRows, visibleRows);
+    int lastRow = min(totalRows, firstRow + visibleRows);
+
+    // find the stage of the first visible row, then walk the rows in view
+    int stage = 0;
+    while (stage < 2 && firstRow >= firstTaskRow[stage + 1] - 3) {
+        stage++;
+    }
+    for (int row = firstRow; row < lastRow; row++) {
+        if (stage < 2 && row == firstTaskRow[stage + 1] - 3) {
+            stage++; // blank row before the next stage header
         }
-        else if (key == "2. In Progress" && !shownInProgress) {
-            cout << "\n    ======= In Progress =" << this->padHeader << "\n" << endl;
-            shownInProgress = true;
+        int headerRow = firstTaskRow[stage] - 2;
+        if (row == headerRow) {
+            this->screen.write(stageHeaders[stage]);
+            this->screen.write(this->padHeader);
+            this->screen.write("\n");
         }
-        else if (key == "3. Done" && !shownDone) {
-            cout << "\n    ======= Done ========" << this->padHeader << "\n" << endl;
-            shownDone = true;
+        else if (row < firstTaskRow[stage] || row >= firstTaskRow[stage] + stageCounts[stage]) {
+            this->screen.write("\n"); // blank rows around stage headers
         }
-
-        for (const string& title : value) { // loop titles in list for the key
-            if (index == this->selectedIndex) {
-                setTextColor(TEXT_GREEN); // highlighted item color
+        else {
+            int taskIndex = firstTask[stage] + (row - firstTaskRow[stage]);
+            if (board->isLoaded(taskIndex)) {
+                displayTitle(board->getTaskAt(taskIndex).getTitle(), taskIndex == this->selectedIndex);
             }
             else {
-                setTextColor(TEXT_WHITE); // regular item color
+                displayTitle("...", taskIndex == this->selectedIndex); // page not loaded yet
             }
-            // print title
-            cout << this->padL << "* " << title << endl;
-            setTextColor(TEXT_WHITE); // reset item color regular
-
-            index++;
         }
     }
+    displayListPosition(board->getTaskCount(), totalRows > visibleRows);
 }
 
-void UI::displayTaskCard(Task* task) {
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+void UI::displaySearchResults(int visibleRows) {
+    // one row per result, the task title and the board it is on
+    int totalRows = static_cast<int>(this->searchResults.size());
+    int firstRow = scrollToRow(this->selectedIndex, totalRows, visibleRows);
+    int lastRow = min(totalRows, firstRow + visibleRows);
+
+    for (int row = firstRow; row < lastRow; row++) {
+        const Database::SearchHit& hit = this->searchResults[row];
+        string& line = this->lineBuffer;
+        line.assign(hit.title).append("  (").append(getBoardById(hit.boardId)->getTitle()).append(")");
+        displayTitle(line, row == this->selectedIndex);
+    }
+    displayListPosition(totalRows, totalRows > visibleRows);
+}
+
+void UI::displayTitle(string_view title, bool selected) {
+    // print one list title, highlighted when selected
+    if (selected) {
+        setTextColor(TextColor::Highlight); // highlighted item color
+    }
+    else {
+        setTextColor(TextColor::Bright); // regular item color
+    }
+    this->screen.write(this->padL);
+    this->screen.write("* ");
+    this->screen.write(title);
+    this->screen.write("\n");
+    setTextColor(TextColor::Bright); // reset item color regular
+}
 
+void UI::displayListPosition(int itemCount, bool clipped) {
+    // footer with the selected position, only when the list does not fit
+    if (clipped) {
+        this->screen.write(this->padL);
+        this->screen.write("(");
+        this->screen.write(to_string(this->selectedIndex + 1));
+        this->screen.write(" of ");
+        this->screen.write(to_string(itemCount));
+        this->screen.write(")\n");
+    }
+}
+
+int UI::scrollToRow(int row, int totalRows, int visibleRows) {
+    // move the viewport just enough to keep the row visible, returns the first visible row
+    if (row < this->scrollTop) {
+        this->scrollTop = max(0, row - 2); // keep a little context above, e.g. the stage header
+    }
+    else if (row >= this->scrollTop + visibleRows) {
+        this->scrollTop = row - visibleRows + 1;
+    }
+    this->scrollTop = max(0, min(this->scrollTop, totalRows - visibleRows));
+    return this->scrollTop;
+}
+
+void UI::displayTaskCard(Task* task) {
     // display card of task information
-    cout << endl;
+    this->screen.write("\n");
 
     // print Title
-    SetConsoleTextAttribute(hConsole, FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << this->padL << "Title: ";
-    SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << task->getTitle() << endl;
+    setTextColor(TextColor::Bright);
+    this->screen.write(this->padL);
+    this->screen.write("Title: ");
+    setTextColor(TextColor::Normal);
+    this->screen.write(task->getTitle());
+    this->screen.write("\n");
 
     // print Description
-    SetConsoleTextAttribute(hConsole, FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << this->padL << "Description: " << endl;
-    SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
+    setTextColor(TextColor::Bright);
+    this->screen.write(this->padL);
+    this->screen.write("Description: \n");
+    setTextColor(TextColor::Normal);
     wrapAndPrint(task->getDescription(), 50); // wrap to 50 characters
 
     // print Stage
-    SetConsoleTextAttribute(hConsole, FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << this->padL << "Stage: ";
-    SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << task->stageToString(task->getStage()) << endl;
+    setTextColor(TextColor::Bright);
+    this->screen.write(this->padL);
+    this->screen.write("Stage: ");
+    setTextColor(TextColor::Normal);
+    this->screen.write(task->stageToString(task->getStage()));
+    this->screen.write("\n");
 
     // print Rated Difficulty
-    SetConsoleTextAttribute(hConsole, FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << this->padL << "Rated Difficulty: ";
-    SetConsoleTextAttribute(hConsole, FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE);
-    cout << task->getDifficulty() << endl;
+    setTextColor(TextColor::Bright);
+    this->screen.write(this->padL);
+    this->screen.write("Rated Difficulty: ");
+    setTextColor(TextColor::Normal);
+    this->screen.write(to_string(task->getDifficulty()));
+    this->screen.write("\n");
+    setTextColor(TextColor::Bright);
 }
 
-void UI::wrapAndPrint(const string& text, int line_length) {
+void UI::wrapAndPrint(string_view text, int line_length) {
     // wrap and print long text
-    istringstream words(text);
-    string word;
-
-    string current_line = this->padL + "    "; // indent first line more
-
-    while (words >> word) {
-        if (current_line.size() + word.size() > line_length) {
-            cout << current_line << endl;
-            current_line = this->padL + " ";;
-        }
-        current_line += word + ' ';
-    }
-
-    if (!current_line.empty())
-        cout << current_line << endl;
+    this->screen.writeWrapped(text, this->padL, line_length);
 }
 
 string UI::getUserInput(const string& prompt) {
     string input;
 
+    if (this->replaying != nullptr) {
+        // headless replay, the line typed at this prompt was recorded
+        return this->replaying->nextLine();
+    }
+
     try {
+        // back to line mode so typed text is echoed and editable
+        this->terminal.setRawMode(false);
         cout << this->padL << prompt;
         getline(cin, input);
+        // the prompt left the screen out of step with the last frame
+        this->screen.invalidate();
 
+        if (cin.fail() && Terminal::wasInterrupted()) {
+            // ctrl+c at the prompt, the next key read quits
+            cin.clear();
+            throw invalid_argument("Quitting.");
+        }
         if (cin.fail()) {
             cin.clear();
             cin.ignore((numeric_limits<streamsize>::max)(), '\n');
             throw invalid_argument("Invalid input.");
         }
+        if (this->recorder != nullptr) {
+            this->recorder->recordLine(input);
+        }
     }
     catch (const invalid_argument&) {
         // reset input to not return bad data & rethrow exception upward
@@ -255,68 +419,150 @@ void UI::addAlert(const string& alert) {
 }
 
 void UI::keyboardListen() {
-    bool keyPressed = false;
+    // wait for a key press (sleeps until input arrives), then react to it
+    int key = this->terminal.readKey();
+    this->inputTime = this->terminal.getKeyTime();
+    this->inputPending = true;
+    if (this->recorder != nullptr) {
+        // recorded before handling, so lines typed at prompts it opens follow it
+        this->recorder->recordKey(key);
+    }
+    handleKey(key);
 
-    while (true) {
-        if (_kbhit()) {
-            keyPressed = true;
-            int ch = _getch();
-
-            switch (ch) {
-            case 224: // potential arrow key
-                ch = _getch();
-                switch (ch) {
-                case 72: moveSelector(-1); break; // up arrow. move selector up 1
-                case 80: moveSelector(1); break; // down arrow. move selector down 1
-                }
-                break;
-            case 13: changeScreen("enter"); break; // enter key. move to selected screen
-            case 'b': changeScreen("back"); break; // back to previous screen
-            case 'c': // create
-                if (this->currScreen == "Boards") {
-                    addNewBoard();
-                }
-                else if (this->currScreen == "Board View") {
-                    addNewTask();
-                }
-                break;
-            case 'd': // delete or edit task description
-                if (this->currScreen == "Boards") {
-                    deleteSelectedBoard();
-                }
-                else if (this->currScreen == "Board View") {
-                    deleteSelectedTask();
-                }
-                else if (this->currScreen == "Task View") {
-                    editTaskDescription();
-                }
-                break;
-            case 'r': // edit task difficulty rating
-                if (this->currScreen == "Task View") {
-                    editTaskRating();
-                }
-                break;
-            case 's': // edit task stage
-                if (this->currScreen == "Task View") {
-                    editTaskStage();
-                }
-                break;
-            case 't': // edit title
-                if (this->currScreen == "Board View") {
-                    editBoardTitle();
-                }
-                else if (this->currScreen == "Task View") {
-                    editTaskTitle();
-                }
-                break;
-            case 27: exit(0); // 'esc', quit program
-            }
+    // time from the key reaching the program to the handler finishing
+    auto handled = chrono::steady_clock::now();
+    this->lastKeyLatency = chrono::duration_cast<chrono::microseconds>(handled - this->terminal.getKeyTime()).count();
+}
+
+void UI::handleKey(int key) {
+    Trace::Span span("handle key");
+    if (!this->inputPending) {
+        // replayed and benchmark keys have no key press time, they start here
+        this->inputTime = chrono::steady_clock::now();
+        this->inputPending = true;
+    }
+    // the search screen takes typed letters as search text
+    if (this->currScreen == "Search" && handleSearchKey(key)) {
+        return;
+    }
+    switch (key) {
+    case Terminal::KEY_UP: moveSelector(-1); break; // up arrow. move selector up 1
+    case Terminal::KEY_DOWN: moveSelector(1); break; // down arrow. move selector down 1
+    case Terminal::KEY_ENTER: changeScreen("enter"); break; // enter key. move to selected screen
+    case 'b': changeScreen("back"); break; // back to previous screen
+    case 'c': // create
+        if (this->currScreen == "Boards") {
+            addNewBoard();
         }
-        if (keyPressed) {
-            // exit while loop to allow display to react to key press
-            break;
+        else if (this->currScreen == "Board View") {
+            addNewTask();
+        }
+        break;
+    case 'd': // delete or edit task description
+        if (this->currScreen == "Boards") {
+            deleteSelectedBoard();
+        }
+        else if (this->currScreen == "Board View") {
+            deleteSelectedTask();
+        }
+        else if (this->currScreen == "Task View") {
+            editTaskDescription();
+        }
+        break;
+    case 'r': // edit task difficulty rating
+        if (this->currScreen == "Task View") {
+            editTaskRating();
+        }
+        break;
+    case 's': // edit task stage
+        if (this->currScreen == "Task View") {
+            editTaskStage();
+        }
+        break;
+    case 't': // edit title
+        if (this->currScreen == "Board View") {
+            editBoardTitle();
+        }
+        else if (this->currScreen == "Task View") {
+            editTaskTitle();
+        }
+        break;
+    case '/': // search tasks of all boards
+        if (this->currScreen == "Boards") {
+            changeScreen("search");
+        }
+        break;
+    case Terminal::KEY_CTRL_T: // save the session stats so far
+        writeStats();
+        break;
+    case Terminal::KEY_CTRL_C: // ctrl+c or a stop signal, quit the same way as esc
+    case Terminal::KEY_ESC: // 'esc', quit program
+        // everything queued is saved before the main loop ends, then the console is
+        // restored and the db closed by destructors
+        waitForWrites();
+        this->running = false;
+        break;
+    }
+    // the selection, or the boards around it, may have changed
+    if (this->currScreen == "Boards") {
+        prefetchAround();
+    }
+}
+
+void UI::writeStats() {
+    ofstream file(STATS_PATH);
+    if (!file) {
+        addAlert(string("Can't write stats to ") + STATS_PATH + ".");
+        return;
+    }
+    Stats::report(file);
+    addAlert(string("Stats written to ") + STATS_PATH + ".");
+}
+
+bool UI::isRunning() {
+    return this->running;
+}
+
+long long UI::getLastKeyLatency() {
+    return this->lastKeyLatency;
+}
+
+ScreenBuffer& UI::getScreen() {
+    return this->screen;
+}
+
+void UI::setRecorder(Session* session) {
+    this->recorder = session;
+}
+
+void UI::setReplay(Session* session) {
+    this->replaying = session;
+}
+
+void UI::setWriter(WriteBehind* writeBehind) {
+    this->writer = writeBehind;
+}
+
+void UI::setPrefetcher(Prefetcher* boardPrefetcher) {
+    this->prefetcher = boardPrefetcher;
+}
+
+void UI::prefetchAround() {
+    // start loading the selected board, then its neighbours, so opening one doesn't wait
+    if (this->prefetcher == nullptr || !this->running) {
+        return;
+    }
+    vector<int> boardIds;
+    int boardCount = static_cast<int>(this->loadedBoards.size());
+    for (int distance = 0; distance <= PREFETCH_NEIGHBOURS; distance++) {
+        for (int index : { this->selectedIndex + distance, this->selectedIndex - distance }) {
+            if (index >= 0 && index < boardCount
+                && find(boardIds.begin(), boardIds.end(), this->loadedBoards[index]->getId()) == boardIds.end()) {
+                boardIds.push_back(this->loadedBoards[index]->getId());
+            }
         }
     }
+    this->prefetcher->request(boardIds, TASK_PAGE_SIZE);
 }
 
 void UI::moveSelector(int direction) {
@@ -328,18 +574,23 @@ void UI::moveSelector(int direction) {
             this->selectedIndex = ((this->selectedIndex + direction + listSize) % listSize);
         }
         else if (this->currScreen == "Board View" && this->activeBoardId != 0) {
-            list<Task*>& tasks = getBoardById(this->activeBoardId)->getTasks();
-            if (tasks.size() > 0) {
+            int taskCount = getBoardById(this->activeBoardId)->getTaskCount();
+            if (taskCount > 0) {
 
-                // how to move selector on board view screen
-                int listSize = static_cast<int>(tasks.size());
+                // how to move selector on board view screen, pages load when the next frame is drawn
+                int listSize = taskCount;
                 this->selectedIndex = ((this->selectedIndex + direction + listSize) % listSize);
             }
         }
+        else if (this->currScreen == "Search" && this->searchResults.size() > 0) {
+            int listSize = static_cast<int>(this->searchResults.size());
+            this->selectedIndex = ((this->selectedIndex + direction + listSize) % listSize);
+        }
     }
 }
 
 void UI::changeScreen(string command) {
+    Trace::Span span("change screen", command);
     // change screen
     if (command == "enter") {
         // move forward to next screen
@@ -359,7 +610,7 @@ void UI::changeScreen(string command) {
         }
         else if (this->currScreen == "Board View") {
             // check for active board with tasks
-            if (this->activeBoardId != 0 && getBoardById(this->activeBoardId)->getTasks().size() > 0) {
+            if (this->activeBoardId != 0 && getBoardById(this->activeBoardId)->getTaskCount() > 0) {
                 // find which task was selected, set active
                 findSelectedTask();
                 // change screen
@@ -369,83 +620,298 @@ void UI::changeScreen(string command) {
                 addAlert("No task selected.");
             }
         }
+        else if (this->currScreen == "Search") {
+            if (this->searchResults.size() > 0) {
+                // open the selected result, its board becomes the active one
+                openSearchResult();
+            }
+            else {
+                addAlert("No task selected.");
+            }
+        }
+    }
+    else if (command == "search") {
+        // start with empty text, results come in as it is typed
+        this->searchText.clear();
+        this->searchResults.clear();
+        this->currScreen = "Search";
     }
     else if (command == "back") {
         // move back to previous screen
         if (this->currScreen == "Task View") {
-            // update the tasks listed for the still active board
-            reloadBoardTasks();
+            // tasks in memory already reflect any edits
             this->currScreen = "Board View";
         }
         else if (this->currScreen == "Board View") {
-            // load list of all boards
-            reloadBoards();
+            // free the tasks of the board being left, boards list is kept as is
+            getBoardById(this->activeBoardId)->setWindow(0, vector<Task>());
+            this->currScreen = "Boards";
+        }
+        else if (this->currScreen == "Search") {
+            this->searchResults.clear();
             this->currScreen = "Boards";
         }
     }
-    // reset selector position
+    // reset selector position and scroll back to the top
     this->setSelectIndex(0);
+    this->scrollTop = 0;
 }
 
-Board* UI::getBoardById(int id) {
-    for (Board* board : this->loadedBoards) {
-        if (board->getId() == id) {
-            return board;
+bool UI::handleSearchKey(int key) {
+    // edit the search text, searching again on every change. returns false for keys handled as usual
+    if (key >= 32 && key <= 126) {
+        this->searchText += static_cast<char>(key);
+    }
+    else if (key == Terminal::KEY_BACKSPACE) {
+        if (!this->searchText.empty()) {
+            this->searchText.pop_back();
         }
     }
+    else if (key == Terminal::KEY_ESC) {
+        changeScreen("back");
+        return true;
+    }
+    else {
+        return false;
+    }
+    runSearch();
+    return true;
+}
+
+void UI::runSearch() {
+    Trace::Span span("search", this->searchText);
+    // results of the current text, selection back on the best match
+    WriteBehind::Pending edits = pendingEdits();
+    this->searchResults = this->db.searchTasks(this->searchText, SEARCH_LIMIT);
+    edits.mergeHits(this->searchResults, this->searchText, SEARCH_LIMIT);
+    this->selectedIndex = 0;
+    this->scrollTop = 0;
+}
+
+void UI::openSearchResult() {
+    // load the board around the found task and show the task
+    WriteBehind::Pending edits = pendingEdits();
+    const Database::SearchHit& hit = this->searchResults[this->selectedIndex];
+    Board* board = getBoardById(hit.boardId);
+    if (!edits.touches(board->getId())) {
+        // with edits queued on the board the counts kept in memory are newer
+        this->db.loadStageCounts(*board);
+    }
+    vector<Task> found;
+    WriteBehind::Pending::Edit* queued = edits.find(hit.taskId);
+    if (queued == nullptr) {
+        found = this->db.loadTask(*board, hit.taskId);
+    }
+    else if (!queued->deleted) {
+        found.push_back(queued->task);
+    }
+    if (found.empty()) {
+        addAlert("Task was deleted.");
+        return;
+    }
+    loadTasksAt(board, found[0], edits);
+    this->activeBoardId = board->getId();
+    this->activeTaskId = hit.taskId;
+    this->searchResults.clear();
+    this->currScreen = "Task View";
+}
+
+Board* UI::getBoardById(int id) {
+    auto found = this->boardIndex.find(id);
+    if (found != this->boardIndex.end()) {
+        return found->second;
+    }
     throw runtime_error("Board with id " + to_string(id) + " not found.");
     return nullptr;
 }
 
 void UI::reloadBoards() {
+    Trace::Span span("reload boards");
     // deallocate and clear current list
+    Stats::add(Stats::Counter::BoardsFreed, static_cast<long long>(this->loadedBoards.size()));
     for (auto board : this->loadedBoards) {
         delete board;
     }
     this->loadedBoards.clear();
-    // reload list from db
+    // reload list from db and index it by id
     this->loadedBoards = this->db.loadBoardsList();
+    Stats::add(Stats::Counter::BoardsAllocated, static_cast<long long>(this->loadedBoards.size()));
+    this->boardIndex.clear();
+    for (Board* board : this->loadedBoards) {
+        this->boardIndex[board->getId()] = board;
+    }
 }
 
 void UI::reloadBoardTasks() {
+    Trace::Span span("reload board tasks");
     // reload tasks for currently active board
     // check if a board is selected
     if (this->activeBoardId != 0) {
-        // reload tasks from DB
+        // reload stage counts and the first page of tasks from DB, other pages load as needed
         Board* board = getBoardById(this->activeBoardId);
-        board->setTasks(this->db.loadTaskData(*board));
+        Prefetcher::Page page;
+        if (this->prefetcher != nullptr && this->prefetcher->take(board->getId(), page)) {
+            // loaded in the background while the board was selected
+            if (page.countsLoaded) {
+                board->setStageCounts(page.stageCounts[0], page.stageCounts[1], page.stageCounts[2]);
+                board->setTotalDifficulty(page.totalDifficulty);
+            }
+            board->setWindow(0, move(page.tasks));
+            return;
+        }
+        WriteBehind::Pending edits = pendingEdits();
+        if (!edits.touches(board->getId())) {
+            this->db.loadStageCounts(*board);
+        }
+        board->setWindow(0, loadPageAfter(*board, -1, 0, edits));
     }
     else {
         addAlert("Select a board before loading tasks.");
     }
 }
 
+void UI::loadTasksNear(int position, int margin) {
+    Trace::Span span("load tasks near");
+    // make sure the active board's tasks within margin of a position are loaded,
+    // fetching pages by key next to the loaded window and dropping pages far away
+    Board* board = getBoardById(this->activeBoardId);
+    int taskCount = board->getTaskCount();
+    int first = max(0, position - margin);
+    int last = min(taskCount, position + margin + 1);
+    if (first >= last || (first >= board->getWindowStart() && last <= board->getWindowEnd())) {
+        return; // nothing to load
+    }
+    WriteBehind::Pending edits = pendingEdits();
+
+    if (board->getWindowEnd() == board->getWindowStart()
+        || last < board->getWindowStart() || first > board->getWindowEnd()) {
+        // nothing loaded next to the range, start again from the nearest end of the board
+        if (last == taskCount && first > 0) {
+            vector<Task> page = loadPageBefore(*board, 3, 0, edits);
+            int start = taskCount - static_cast<int>(page.size());
+            board->setWindow(start, move(page));
+        }
+        else {
+            board->setWindow(0, loadPageAfter(*board, -1, 0, edits));
+        }
+    }
+
+    // extend forward from the last loaded task
+    while (board->getWindowEnd() < last) {
+        Task& lastTask = board->getTaskAt(board->getWindowEnd() - 1);
+        vector<Task> page = loadPageAfter(*board, static_cast<int>(lastTask.getStage()), lastTask.getId(), edits);
+        if (page.empty()) {
+            break; // stage counts are ahead of the db
+        }
+        board->appendTasks(move(page));
+        if (board->getWindowEnd() - board->getWindowStart() > MAX_LOADED_TASKS) {
+            board->trimTasks(board->getWindowEnd() - MAX_LOADED_TASKS, board->getWindowEnd());
+        }
+    }
+    // extend backward from the first loaded task
+    while (board->getWindowStart() > first) {
+        Task& firstTask = board->getTaskAt(board->getWindowStart());
+        vector<Task> page = loadPageBefore(*board, static_cast<int>(firstTask.getStage()), firstTask.getId(), edits);
+        if (page.empty()) {
+            break;
+        }
+        board->prependTasks(move(page));
+        if (board->getWindowEnd() - board->getWindowStart() > MAX_LOADED_TASKS) {
+            board->trimTasks(board->getWindowStart(), board->getWindowStart() + MAX_LOADED_TASKS);
+        }
+    }
+}
+
+void UI::loadTasksAt(Board* board, Task& task, WriteBehind::Pending& edits) {
+    // load the page starting at a task, placed at the task's board position.
+    // edited tasks are counted from their queued state, the database may still have an older one
+    int position = this->db.countTasksBefore(*board, task, edits.taskIds()) + edits.countBefore(board->getId(), task);
+    board->setWindow(position, loadPageAfter(*board, static_cast<int>(task.getStage()), task.getId() - 1, edits));
+}
+
+// the page of tasks after a (stage rank, id) key, with the queued edits laid over it
+vector<Task> UI::loadPageAfter(Board& board, int afterRank, int afterId, WriteBehind::Pending& edits) {
+    while (true) {
+        vector<Task> page = this->db.loadTaskPage(board, afterRank, afterId, TASK_PAGE_SIZE);
+        // a short page reached the end of the board, a full one covers up to its last task
+        bool full = (page.size() == TASK_PAGE_SIZE);
+        pair<int, int> last = { INT_MAX, INT_MAX };
+        if (full) {
+            last = { static_cast<int>(page.back().getStage()), page.back().getId() };
+        }
+        edits.merge(page, board.getId(), { afterRank, afterId + 1 }, last);
+        if (!page.empty() || !full) {
+            return page;
+        }
+        // every task of the page was edited away, carry on past it
+        afterRank = last.first;
+        afterId = last.second;
+    }
+}
+
+// the page of tasks before a (stage rank, id) key, with the queued edits laid over it
+vector<Task> UI::loadPageBefore(Board& board, int beforeRank, int beforeId, WriteBehind::Pending& edits) {
+    while (true) {
+        vector<Task> page = this->db.loadTaskPageBefore(board, beforeRank, beforeId, TASK_PAGE_SIZE);
+        bool full = (page.size() == TASK_PAGE_SIZE);
+        pair<int, int> first = { INT_MIN, INT_MIN };
+        if (full) {
+            first = { static_cast<int>(page.front().getStage()), page.front().getId() };
+        }
+        edits.merge(page, board.getId(), first, { beforeRank, beforeId - 1 });
+        if (!page.empty() || !full) {
+            return page;
+        }
+        beforeRank = first.first;
+        beforeId = first.second;
+    }
+}
+
+void UI::placeBoard(Board* board) {
+    // insert board in the title, id order boards are loaded in
+    vector<Board*>::iterator boardIter = this->loadedBoards.begin();
+    while (boardIter != this->loadedBoards.end()) {
+        Board* other = *boardIter;
+        if (board->getTitle() < other->getTitle()
+            || (board->getTitle() == other->getTitle() && board->getId() < other->getId())) {
+            break;
+        }
+        boardIter++;
+    }
+    this->loadedBoards.insert(boardIter, board);
+    this->boardIndex[board->getId()] = board;
+}
+
 void UI::findSelectedBoard() {
     // find selected board, set active
-    list<Board*>::iterator boardIter = this->loadedBoards.begin();
-    advance(boardIter, this->selectedIndex);
-    this->activeBoardId = (*boardIter)->getId(); // deref iterator returns Board*. set active board id
+    this->activeBoardId = this->loadedBoards[this->selectedIndex]->getId(); // boards are in display order
 
     this->selectedIndex = 0;
 }
 
 void UI::findSelectedTask() {
     // find selected task, set active. access tasks from the active board
-    list<Task*>::iterator taskIter = getBoardById(this->activeBoardId)->getTasks().begin();
-    advance(taskIter, this->selectedIndex);
-    this->activeTaskId = (*taskIter)->getId(); // deref iterator returns Task*, get id.
+    Board* activeBoard = getBoardById(this->activeBoardId);
+    this->activeTaskId = activeBoard->getTaskAt(this->selectedIndex).getId(); // tasks are in display order
 
     this->selectedIndex = 0;
 }
 
 void UI::addNewBoard() {
+    Trace::Span span("add board");
     try {
         string newBoardTitle = getUserInput("Enter a title for the new board: ");
-        Board newBoard(newBoardTitle);
+        Board* newBoard = new Board(newBoardTitle);
         // save board to db
-        this->db.saveBoardData(newBoard);
-        // reload list of boards
-        reloadBoards();
+        try {
+            writeBoard(*newBoard);
+        }
+        catch (...) {
+            delete newBoard;
+            throw;
+        }
+        // add to the loaded boards without reloading the list
+        placeBoard(newBoard);
     }
     catch (invalid_argument& e) {
         // catch invalid_argument from getUserInput or new board
@@ -454,16 +920,18 @@ void UI::addNewBoard() {
 }
 
 void UI::addNewTask() {
+    Trace::Span span("add task");
     // check there is an active board
     if (this->activeBoardId != 0) {
         try {
             // Add new task to board
             string newTaskTitle = getUserInput("Enter a title for the new task: ");
-            Task newTask(newTaskTitle, *getBoardById(this->activeBoardId));
+            Board* activeBoard = getBoardById(this->activeBoardId);
+            Task newTask(newTaskTitle, *activeBoard);
             // save task to db
-            this->db.saveTaskData(newTask);
-            // reload tasks for active board
-            reloadBoardTasks();
+            writeTask(newTask);
+            // add saved copy to the board in its sorted place
+            activeBoard->addTask(newTask);
         }
         catch (invalid_argument& e) {
             // catch invalid_argument from getUserInput or new task
@@ -477,15 +945,17 @@ void UI::addNewTask() {
 }
 
 void UI::deleteSelectedBoard() {
+    Trace::Span span("delete board");
     // check if there are boards
     if (this->loadedBoards.size() > 0) {
         // find the selected board
-        list<Board*>::iterator boardIter = this->loadedBoards.begin();
-        advance(boardIter, this->selectedIndex);
+        vector<Board*>::iterator boardIter = this->loadedBoards.begin() + this->selectedIndex;
         // delete board from DB
-        this->db.deleteBoard(**boardIter); // deref iterator gets board ptr, then deref ptr
-        // reload list of boards
-        reloadBoards();
+        writeBoardDelete(**boardIter); // deref iterator gets board ptr, then deref ptr
+        // drop it from the loaded boards
+        this->boardIndex.erase((*boardIter)->getId());
+        delete *boardIter;
+        this->loadedBoards.erase(boardIter);
         // fix selected index if was at end of list
         this->selectedIndex = min(this->selectedIndex, static_cast<int>(this->loadedBoards.size()) - 1);
     }
@@ -496,20 +966,20 @@ void UI::deleteSelectedBoard() {
 }
 
 void UI::deleteSelectedTask() {
+    Trace::Span span("delete task");
     // check if there is an active board, then get its tasks
     if (this->activeBoardId != 0) {
-        list<Task*>& tasks = getBoardById(this->activeBoardId)->getTasks();
+        Board* activeBoard = getBoardById(this->activeBoardId);
 
-        if (tasks.size() > 0) {
-            // find selected task
-            list<Task*>::iterator taskIter = tasks.begin();
-            advance(taskIter, this->selectedIndex);
+        if (activeBoard->getTaskCount() > 0) {
+            // find selected task, tasks are in display order
+            Task& selectedTask = activeBoard->getTaskAt(this->selectedIndex);
             // delete task from DB
-            this->db.deleteTask(**taskIter); // deref iterator gets task ptr, then deref ptr
-            // reload tasks for active board
-            reloadBoardTasks();
+            writeTaskDelete(selectedTask);
+            // drop it from the active board
+            activeBoard->removeTask(selectedTask.getId());
             // fix selected index if at end of list
-            this->selectedIndex = min(this->selectedIndex, static_cast<int>(tasks.size()) - 1);
+            this->selectedIndex = min(this->selectedIndex, activeBoard->getTaskCount() - 1);
         }
         else {
             addAlert("No tasks to delete.");
@@ -522,18 +992,101 @@ void UI::deleteSelectedTask() {
     }
 }
 
+// edits go through the write-behind thread when there is one. new records get their
+// ids here, so they can be placed and shown before they are written
+void UI::writeBoard(Board& board) {
+    if (this->writer != nullptr) {
+        if (board.getId() == 0) {
+            board.setId(this->writer->newBoardId());
+            this->writer->createBoard(board);
+        }
+        else {
+            this->writer->saveBoard(board);
+        }
+    }
+    else {
+        this->db.saveBoardData(board);
+    }
+}
+
+// a prefetched page is dropped after the edit is queued, so a load that started before can't keep it
+void UI::writeTask(Task& task) {
+    if (this->writer != nullptr) {
+        if (task.getId() == 0) {
+            task.setId(this->writer->newTaskId());
+            this->writer->createTask(task);
+        }
+        else {
+            this->writer->saveTask(task);
+        }
+    }
+    else {
+        this->db.saveTaskData(task);
+    }
+    if (this->prefetcher != nullptr) {
+        this->prefetcher->forget(task.getBoardId());
+    }
+}
+
+void UI::writeBoardDelete(Board& board) {
+    if (this->writer != nullptr) {
+        this->writer->deleteBoard(board);
+    }
+    else {
+        this->db.deleteBoard(board);
+    }
+    if (this->prefetcher != nullptr) {
+        this->prefetcher->forget(board.getId());
+    }
+}
+
+void UI::writeTaskDelete(Task& task) {
+    if (this->writer != nullptr) {
+        this->writer->deleteTask(task);
+    }
+    else {
+        this->db.deleteTask(task);
+    }
+    if (this->prefetcher != nullptr) {
+        this->prefetcher->forget(task.getBoardId());
+    }
+}
+
+// edits queued but not written yet, taken before a read so it can be combined with them.
+// only quitting waits for the writer, reads never do
+WriteBehind::Pending UI::pendingEdits() {
+    if (this->writer != nullptr) {
+        return this->writer->pending();
+    }
+    return WriteBehind::Pending();
+}
+
+void UI::waitForWrites() {
+    // everything queued is in the database before the program ends
+    if (this->writer != nullptr && !this->writer->isIdle()) {
+        this->writer->flush();
+    }
+}
+
 void UI::editBoardTitle() {
+    Trace::Span span("edit board title");
     if (this->activeBoardId != 0) {
         try {
             string newTitle = getUserInput("Enter a new title for the board: ");
 
             Board* activeBoard = getBoardById(this->activeBoardId);
-            activeBoard->setTitle(newTitle);
-            // save board to db and reload board list
-            this->db.saveBoardData(*activeBoard);
-            reloadBoards();
-            // reload tasks in board view (reloadBoards drops tasks lists)
-            reloadBoardTasks();
+            string oldTitle = activeBoard->getTitle();
+            activeBoard->setTitle(move(newTitle));
+            // save board to db and move it to its new sorted place, a failed save puts the old title back
+            try {
+                writeBoard(*activeBoard);
+            }
+            catch (...) {
+                activeBoard->setTitle(move(oldTitle));
+                throw;
+            }
+            this->loadedBoards.erase(find(this->loadedBoards.begin(), this->loadedBoards.end(), activeBoard));
+            placeBoard(activeBoard);
         }
         catch (invalid_argument& e) {
             // catch invalid_argument from setTitle or getUserInput
@@ -547,15 +1100,17 @@ void UI::editBoardTitle() {
 }
 
 void UI::editTaskTitle() {
+    Trace::Span span("edit task title");
     if (this->activeBoardId != 0 && this->activeTaskId != 0) {
         Task* activeTask = getBoardById(this->activeBoardId)->getTaskById(this->activeTaskId);
 
         try {
             string newTitle = getUserInput("Enter a new title for the task: ");
-            activeTask->setTitle(newTitle);
-            // save task to db and reload task list
-            this->db.saveTaskData(*activeTask);
-            reloadBoardTasks();
+            // save a changed copy first, the board only shows the edit once it is saved
+            Task changedTask = *activeTask;
+            changedTask.setTitle(move(newTitle));
+            writeTask(changedTask);
+            *activeTask = move(changedTask);
         }
         catch (invalid_argument& e) {
             // catch invalid_argument from setTitle or getUserInput
@@ -569,15 +1124,17 @@ void UI::editTaskTitle() {
 }
 
 void UI::editTaskDescription() {
+    Trace::Span span("edit task description");
     if (this->activeBoardId != 0 && this->activeTaskId != 0) {
         Task* activeTask = getBoardById(this->activeBoardId)->getTaskById(this->activeTaskId);
 
         try {
             string newDescription = getUserInput("Enter a new description for the task: ");
-            activeTask->setDescription(newDescription);
-            // save task to db and reload task list
-            this->db.saveTaskData(*activeTask);
-            reloadBoardTasks();
+            // save a changed copy first, the board only shows the edit once it is saved
+            Task changedTask = *activeTask;
+            changedTask.setDescription(move(newDescription));
+            writeTask(changedTask);
+            *activeTask = move(changedTask);
         }
         catch (invalid_argument& e) {
             // catch invalid_argument from setDescription or getUserInput
@@ -591,6 +1148,7 @@ void UI::editTaskDescription() {
 }
 
 void UI::editTaskStage() {
+    Trace::Span span("edit task stage");
     if (this->activeBoardId != 0 && this->activeTaskId != 0) {
         Task* activeTask = getBoardById(this->activeBoardId)->getTaskById(this->activeTaskId);
 
@@ -612,11 +1170,17 @@ void UI::editTaskStage() {
                 // catches failed stoi() convert or switch default
                 throw invalid_argument("Invalid stage selection. Enter 1, 2 or 3.");
             }
-            // update task and save to db
-            activeTask->setStage(newStage, false);
-            this->db.saveTaskData(*activeTask);
-            // reload board tasks from db
-            reloadBoardTasks();
+            // update a copy of the task and save it to db, a refused stage changes nothing
+            Task changedTask = *activeTask;
+            changedTask.setStage(newStage, false);
+            writeTask(changedTask);
+            // move the task to its new stage group, keeping the board's stage counts in step
+            Board* activeBoard = getBoardById(this->activeBoardId);
+            if (!activeBoard->changeStage(this->activeTaskId, newStage)) {
+                // its new place is outside the loaded pages, load the page it moved to
+                WriteBehind::Pending edits = pendingEdits();
+                loadTasksAt(activeBoard, changedTask, edits);
+            }
         }
         catch (invalid_argument& e) {
             // catch invalid_argument from above try or setStage
@@ -630,8 +1194,9 @@ void UI::editTaskStage() {
 }
 
 void UI::editTaskRating() {
+    Trace::Span span("edit task rating");
     if (this->activeBoardId != 0 && this->activeTaskId != 0) {
-        Task* activeTask = getBoardById(this->activeBoardId)->getTaskById(this->activeTaskId);
+        Board* activeBoard = getBoardById(this->activeBoardId);
 
         try {
             string strRating = getUserInput("Enter difficulty rating for the task (number 1 - 5): ");
@@ -643,11 +1208,11 @@ void UI::editTaskRating() {
                 // catches failed stoi() convert
                 throw invalid_argument("Enter a number between 1 and 5.");
             }
-            // update task and save to db
-            activeTask->setDifficulty(newRating);
-            this->db.saveTaskData(*activeTask);
-            // reload board tasks from db
-            reloadBoardTasks();
+            // save a rated copy first, then rate the task on the board so its total follows
+            Task changedTask = *activeBoard->getTaskById(this->activeTaskId);
+            changedTask.setDifficulty(newRating);
+            writeTask(changedTask);
+            activeBoard->rateTask(this->activeTaskId, newRating);
         }
         catch (invalid_argument& e) {
             // catch invalid_argument from above try or setDifficulty
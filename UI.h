@@ -1,50 +1,88 @@
 #ifndef UI_H
 #define UI_H
 
-// exclude parts of <windows.h> causing build errors
-#define WIN32_LEAN_AND_MEAN
-#define RPC_NO_WINDOWS_H
-#include <windows.h>
-
 #include "Database.h"
 #include "Board.h"
 #include "Task.h"
+#include "Terminal.h"
+#include "ScreenBuffer.h"
+#include "Session.h"
+#include "WriteBehind.h"
+#include "Prefetcher.h"
+#include "Stats.h"
+#include "Trace.h"
 #include <iostream>
+#include <fstream>
 #include <sstream>
-#include <conio.h>
+#include <algorithm>
+#include <limits>
+#include <climits>
+#include <chrono>
 #include <variant>
 #include <string>
+#include <string_view>
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 using namespace std;
 
 class UI {
 public:
-    UI(Database& db);
+    UI(Database& db, bool offscreen = false);
     ~UI();
     // methods to manipulate the interface
-    void setTextColor(const WORD color);
+    void setTextColor(const TextColor color);
     void setSelectIndex(const int index);
     void displayScreen();
-    void displayTitles(map<string, list<string>>& titles);
+    void displayBoardList(int visibleRows);
+    void displayTaskList(Board* board, int visibleRows);
+    void displayTitle(string_view title, bool selected);
+    void displayListPosition(int itemCount, bool clipped);
+    int scrollToRow(int row, int totalRows, int visibleRows);
     void displayTaskCard(Task* task);
-    void wrapAndPrint(const string& text, int line_length);
+    void displaySearchResults(int visibleRows);
+    void wrapAndPrint(string_view text, int line_length);
     string getUserInput(const string& prompt);
     void addAlert(const string& alert);
+    void writeStats();
     void keyboardListen();
+    void handleKey(int key);
+    bool isRunning();
+    long long getLastKeyLatency();
+    ScreenBuffer& getScreen();
+    void setRecorder(Session* session);
+    void setReplay(Session* session);
+    void setWriter(WriteBehind* writeBehind);
+    void setPrefetcher(Prefetcher* boardPrefetcher);
+    void prefetchAround();
     void moveSelector(int direction);
     void changeScreen(string command);
+    bool handleSearchKey(int key);
+    void runSearch();
+    void openSearchResult();
 
     // methods to manage displayed boards and tasks
     Board* getBoardById(int id);
     void reloadBoards();
     void reloadBoardTasks();
+    void loadTasksNear(int position, int margin);
+    void loadTasksAt(Board* board, Task& task, WriteBehind::Pending& edits);
+    vector<Task> loadPageAfter(Board& board, int afterRank, int afterId, WriteBehind::Pending& edits);
+    vector<Task> loadPageBefore(Board& board, int beforeRank, int beforeId, WriteBehind::Pending& edits);
+    void placeBoard(Board* board);
     void findSelectedBoard();
     void findSelectedTask();
     void addNewBoard();
     void addNewTask();
     void deleteSelectedBoard();
     void deleteSelectedTask();
+    void writeBoard(Board& board);
+    void writeTask(Task& task);
+    void writeBoardDelete(Board& board);
+    void writeTaskDelete(Task& task);
+    WriteBehind::Pending pendingEdits();
+    void waitForWrites();
 
     // methods to edit displayed boards and tasks
     void editBoardTitle();
@@ -54,20 +92,40 @@ public:
     void editTaskRating();
 
 private:
-    const WORD TEXT_WHITE = FOREGROUND_INTENSITY | FOREGROUND_RED | FOREGROUND_GREEN | FOREGROUND_BLUE;
-    const WORD TEXT_GREEN = FOREGROUND_INTENSITY | FOREGROUND_GREEN;
+    static const int TASK_PAGE_SIZE = 200; // tasks fetched per query
+    static const int MAX_LOADED_TASKS = 1000; // most tasks of a board kept in memory
+    static const int SEARCH_LIMIT = 50; // search results shown
+    static const int PREFETCH_NEIGHBOURS = 1; // boards either side of the selection prefetched
+    static constexpr const char* STATS_PATH = "kanban_stats.txt"; // ctrl+t writes the session stats here
 
-    Database db;
-    map<string, string> screenMenus;
+    Database& db;
+    Terminal terminal;
+    ScreenBuffer screen;
+    Session* recorder; // keys and typed lines are written here when set
+    Session* replaying; // typed lines come from here instead of the console when set
+    WriteBehind* writer; // edits are saved in the background when set, else right away
+    Prefetcher* prefetcher; // loads boards near the selection in the background when set
+    bool running; // false once the user quits
+    long long lastKeyLatency; // microseconds from key press to handler done
+    chrono::steady_clock::time_point inputTime; // key press not yet shown in a frame
+    bool inputPending;
+    map<string, string> screenMenus; // centered menu line of each screen
+    string menuTop; // centered title line
+    string menuBottom;
     list<string> userAlerts;
     int screenWidth;
     string padL;
     string padHeader;
+    string lineBuffer; // list lines composed from several parts, reused between frames
     int selectedIndex;
+    int scrollTop; // first list row shown in the viewport
     string currScreen;
-    list<Board*> loadedBoards;
+    vector<Board*> loadedBoards;
+    unordered_map<int, Board*> boardIndex; // board id to loaded board
     int activeBoardId;
     int activeTaskId;
+    string searchText; // typed on the search screen
+    vector<Database::SearchHit> searchResults; // best match first
 };
 
 #endif // UI_H
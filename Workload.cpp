@@ -0,0 +1,172 @@
+#include "Workload.h"
+
+using namespace std;
+
+// words titles and descriptions are made of
+static const vector<string> WORDS = {
+    "fix", "add", "update", "remove", "review", "login", "page", "report", "export", "import",
+    "crash", "slow", "query", "cache", "button", "layout", "test", "docs", "release", "build",
+    "user", "board", "task", "stage", "rating", "search", "filter", "sort", "color", "menu",
+    "when", "the", "on", "after", "with", "for", "and", "in", "of", "to"
+};
+
+Workload::Workload() : random(1) {
+    this->taskCount = 1000;
+    this->boardCount = 10;
+    this->boardSkew = 0;
+    this->titleMin = 10;
+    this->titleMax = 40;
+    this->descriptionMin = 0;
+    this->descriptionMax = 300;
+    this->stageMix = discrete_distribution<int>({ 40, 30, 30 });
+    this->difficultyMix = discrete_distribution<int>({ 1, 2, 3, 2, 1 });
+}
+
+// set one option by name, values as on the command line
+void Workload::setOption(const string& key, const string& value) {
+    try {
+        if (key == "tasks") {
+            this->taskCount = stoll(value);
+        }
+        else if (key == "boards") {
+            this->boardCount = max(1, stoi(value));
+        }
+        else if (key == "skew") {
+            this->boardSkew = stod(value);
+        }
+        else if (key == "title-length") {
+            parseRange(value, this->titleMin, this->titleMax, 50);
+            this->titleMin = max(1, this->titleMin);
+        }
+        else if (key == "description-length") {
+            parseRange(value, this->descriptionMin, this->descriptionMax, 500);
+        }
+        else if (key == "stages") {
+            vector<double> weights = parseWeights(value, 3);
+            this->stageMix = discrete_distribution<int>(weights.begin(), weights.end());
+        }
+        else if (key == "difficulty") {
+            vector<double> weights = parseWeights(value, 5);
+            this->difficultyMix = discrete_distribution<int>(weights.begin(), weights.end());
+        }
+        else if (key == "seed") {
+            this->random.seed(static_cast<unsigned int>(stoul(value)));
+        }
+        else {
+            throw invalid_argument("unknown option");
+        }
+    }
+    catch (const logic_error& e) {
+        throw invalid_argument("Workload option " + key + " = '" + value + "': " + e.what());
+    }
+}
+
+// options given as --key value pairs
+void Workload::setArgs(const vector<string>& args) {
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].rfind("--", 0) != 0 || i + 1 >= args.size()) {
+            throw invalid_argument("Expected --option value, got " + args[i]);
+        }
+        setOption(args[i].substr(2), args[i + 1]);
+        i++;
+    }
+}
+
+// add the boards and their tasks to the database, a batch at a time
+void Workload::generate(Database& db, ostream& output) {
+    long long made = 0;
+    for (int b = 0; b < this->boardCount; b++) {
+        Board board("Board " + to_string(b + 1) + " " + makeText(5, 30));
+        db.saveBoardData(board);
+
+        long long count = tasksForBoard(b);
+        vector<Task> batch;
+        for (long long i = 0; i < count; i++) {
+            batch.push_back(makeTask(board));
+            if (batch.size() == 1000 || i == count - 1) {
+                db.saveTasks(batch);
+                batch.clear();
+            }
+        }
+        made += count;
+        output << "board " << board.getId() << ": " << count << " tasks" << endl;
+    }
+    output << made << " tasks on " << this->boardCount << " boards" << endl;
+}
+
+// tasks given to a board, board weights fall off as 1 / (n + 1)^skew
+long long Workload::tasksForBoard(int boardNumber) {
+    double total = 0;
+    for (int b = 0; b < this->boardCount; b++) {
+        total += pow(b + 1, -this->boardSkew);
+    }
+    // the first board also takes what rounding leaves over
+    long long given = 0;
+    for (int b = 1; b < this->boardCount; b++) {
+        given += static_cast<long long>(this->taskCount * pow(b + 1, -this->boardSkew) / total);
+    }
+    if (boardNumber == 0) {
+        return this->taskCount - given;
+    }
+    return static_cast<long long>(this->taskCount * pow(boardNumber + 1, -this->boardSkew) / total);
+}
+
+Task Workload::makeTask(Board& board) {
+    Task task(makeText(this->titleMin, this->titleMax), board);
+    task.setDescription(makeText(this->descriptionMin, this->descriptionMax));
+    task.setDifficulty(this->difficultyMix(this->random) + 1);
+    Stage stage = static_cast<Stage>(this->stageMix(this->random));
+    if (stage != Stage::ToDo && task.getDescription().empty()) {
+        // started tasks need a description
+        task.setDescription(makeText(10, 40));
+    }
+    task.setStage(stage, true);
+    return task;
+}
+
+int Workload::getBoardCount() {
+    return this->boardCount;
+}
+
+// random words, cut to a length picked between min and max
+string Workload::makeText(int minLength, int maxLength) {
+    int length = uniform_int_distribution<int>(minLength, maxLength)(this->random);
+    string text;
+    uniform_int_distribution<size_t> pickWord(0, WORDS.size() - 1);
+    while (static_cast<int>(text.size()) < length) {
+        if (!text.empty()) {
+            text += ' ';
+        }
+        text += WORDS[pickWord(this->random)];
+    }
+    text.resize(length);
+    // a cut can leave a trailing space
+    if (!text.empty() && text.back() == ' ') {
+        text.back() = '.';
+    }
+    return text;
+}
+
+// "low-high" or a single number, within 0 and limit
+void Workload::parseRange(const string& value, int& low, int& high, int limit) {
+    size_t dash = value.find('-');
+    low = stoi(value.substr(0, dash));
+    high = (dash == string::npos) ? low : stoi(value.substr(dash + 1));
+    if (low < 0 || high > limit || low > high) {
+        throw invalid_argument("range must be within 0-" + to_string(limit));
+    }
+}
+
+// comma separated weights, one per choice
+vector<double> Workload::parseWeights(const string& value, size_t count) {
+    vector<double> weights;
+    stringstream list(value);
+    string weight;
+    while (getline(list, weight, ',')) {
+        weights.push_back(stod(weight));
+    }
+    if (weights.size() != count) {
+        throw invalid_argument("expected " + to_string(count) + " comma separated weights");
+    }
+    return weights;
+}
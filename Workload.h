@@ -0,0 +1,45 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "Database.h"
+#include "Board.h"
+#include "Task.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <random>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// generates boards and tasks with configurable, repeatable distributions
+class Workload {
+public:
+    Workload();
+    void setOption(const string& key, const string& value);
+    void setArgs(const vector<string>& args);
+    void generate(Database& db, ostream& output);
+    long long tasksForBoard(int boardNumber);
+    Task makeTask(Board& board);
+    int getBoardCount();
+
+private:
+    string makeText(int minLength, int maxLength);
+    static void parseRange(const string& value, int& low, int& high, int limit);
+    static vector<double> parseWeights(const string& value, size_t count);
+
+    long long taskCount; // tasks over all boards
+    int boardCount;
+    double boardSkew; // 0 spreads tasks evenly, higher puts more on the first boards
+    int titleMin;
+    int titleMax; // up to the 50 char limit
+    int descriptionMin;
+    int descriptionMax; // up to the 500 char limit
+    discrete_distribution<int> stageMix; // weights of To Do, In Progress, Done
+    discrete_distribution<int> difficultyMix; // weights of ratings 1 to 5
+    mt19937 random;
+};
+
+#endif // WORKLOAD_H
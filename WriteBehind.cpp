@@ -0,0 +1,465 @@
+#include "WriteBehind.h"
+
+using namespace std;
+
+WriteBehind::WriteBehind(Database& db) : db(db) {
+    this->nextBoardId = this->db.nextId("Boards");
+    this->nextTaskId = this->db.nextId("Tasks");
+    this->stub.next = nullptr;
+    this->head = &this->stub;
+    this->tail = &this->stub;
+    this->queued = 0;
+    this->taken = 0;
+    this->written = 0;
+    this->commitCount = 0;
+    this->mergedCount = 0;
+    this->sleeping = false;
+    this->stopping = false;
+    this->lastSequence = 0;
+    this->writer = thread(&WriteBehind::run, this);
+}
+
+WriteBehind::~WriteBehind() {
+    // the writer empties the queue before it stops, no edit is lost on quit
+    {
+        lock_guard<mutex> lock(this->wakeMutex);
+        this->stopping = true;
+    }
+    this->wake.notify_one();
+    this->writer.join();
+    string failed = takeError();
+    if (!failed.empty()) {
+        cerr << "Saving failed: " << failed << endl;
+    }
+}
+
+int WriteBehind::newBoardId() {
+    return this->nextBoardId++;
+}
+
+int WriteBehind::newTaskId() {
+    return this->nextTaskId++;
+}
+
+// queue a copy of the record, the caller keeps editing its own. a create is written
+// with a plain insert of its id, so an id taken by another process fails instead of
+// overwriting that row
+void WriteBehind::createBoard(Board& board) {
+    push(new Mutation{ Kind::CreateBoard, board.getId(), board.getTitle(), nullopt, { nullptr }, 0 });
+}
+
+void WriteBehind::saveBoard(Board& board) {
+    push(new Mutation{ Kind::SaveBoard, board.getId(), board.getTitle(), nullopt, { nullptr }, 0 });
+}
+
+void WriteBehind::deleteBoard(Board& board) {
+    push(new Mutation{ Kind::DeleteBoard, board.getId(), board.getTitle(), nullopt, { nullptr }, 0 });
+}
+
+void WriteBehind::createTask(Task& task) {
+    push(new Mutation{ Kind::CreateTask, task.getId(), "", task, { nullptr }, 0 });
+}
+
+void WriteBehind::saveTask(Task& task) {
+    push(new Mutation{ Kind::SaveTask, task.getId(), "", task, { nullptr }, 0 });
+}
+
+void WriteBehind::deleteTask(Task& task) {
+    push(new Mutation{ Kind::DeleteTask, task.getId(), "", task, { nullptr }, 0 });
+}
+
+// a copy of the edits not written yet, taken before a read that should include them
+WriteBehind::Pending WriteBehind::pending() {
+    lock_guard<mutex> lock(this->pendingMutex);
+    return this->pendingEdits;
+}
+
+// wait until every edit queued so far is in the database
+void WriteBehind::flush() {
+    long long target = this->queued;
+    unique_lock<mutex> lock(this->wakeMutex);
+    this->done.wait(lock, [this, target]() { return this->written >= target; });
+}
+
+// true when nothing queued is still waiting to be written
+bool WriteBehind::isIdle() {
+    return this->written == this->queued;
+}
+
+// the last write that failed, cleared once read
+string WriteBehind::takeError() {
+    lock_guard<mutex> lock(this->wakeMutex);
+    string failed = move(this->error);
+    this->error.clear();
+    return failed;
+}
+
+long long WriteBehind::getCommitCount() {
+    return this->commitCount;
+}
+
+long long WriteBehind::getMergedCount() {
+    return this->mergedCount;
+}
+
+// queue an edit and wake the writer if it sleeps, any thread may call this
+void WriteBehind::push(Mutation* mutation) {
+    {
+        // readers see the edit from now until it is written
+        lock_guard<mutex> lock(this->pendingMutex);
+        mutation->sequence = ++this->lastSequence;
+        bool isTask = mutation->task.has_value();
+        if (isTask) {
+            this->pendingEdits.tasks.erase(mutation->id);
+            this->pendingEdits.tasks.insert({ mutation->id, { *mutation->task, mutation->kind == Kind::DeleteTask } });
+        }
+        else if (mutation->kind == Kind::DeleteBoard) {
+            this->pendingEdits.deletedBoards.insert(mutation->id);
+        }
+        if (isTask || mutation->kind == Kind::DeleteBoard) {
+            this->pendingSequences[recordKey(*mutation)] = mutation->sequence;
+        }
+    }
+    link(mutation);
+    this->queued++;
+    // only wake the writer when it sleeps, the lock makes sure it is waiting when notified
+    if (this->sleeping) {
+        lock_guard<mutex> lock(this->wakeMutex);
+        this->wake.notify_one();
+    }
+}
+
+// add a node at the head without locking
+void WriteBehind::link(Mutation* mutation) {
+    mutation->next = nullptr;
+    Mutation* previous = this->head.exchange(mutation);
+    // the node is reachable from the tail once the previous head links to it
+    previous->next = mutation;
+}
+
+// take the oldest edit, writer thread only. returns nullptr when empty or when a
+// push is half done, the caller tries again
+WriteBehind::Mutation* WriteBehind::pop() {
+    Mutation* first = this->tail;
+    Mutation* next = first->next;
+    if (first == &this->stub) {
+        if (next == nullptr) {
+            return nullptr;
+        }
+        // step past the stub
+        this->tail = next;
+        first = next;
+        next = next->next;
+    }
+    if (next != nullptr) {
+        this->tail = next;
+        return first;
+    }
+    if (first != this->head) {
+        return nullptr;
+    }
+    // first is the only node, put the stub behind it so it can be taken
+    link(&this->stub);
+    next = first->next;
+    if (next != nullptr) {
+        this->tail = next;
+        return first;
+    }
+    return nullptr;
+}
+
+void WriteBehind::run() {
+    Trace::nameThread("writer");
+    while (true) {
+        {
+            unique_lock<mutex> lock(this->wakeMutex);
+            this->sleeping = true;
+            this->wake.wait(lock, [this]() { return this->queued > this->taken || this->stopping; });
+            this->sleeping = false;
+            if (this->queued == this->taken && this->stopping) {
+                return;
+            }
+        }
+        writeGroup();
+    }
+}
+
+// commit everything queued as one transaction, keeping only the last save of each record
+void WriteBehind::writeGroup() {
+    Trace::Span span("write group");
+    vector<Mutation*> group;
+    unordered_map<long long, size_t> saves; // record to the place of its save in the group
+    vector<pair<long long, long long>> taken; // record and sequence of every edit taken, merged or not
+    long long target = this->queued;
+    while (this->taken < target) {
+        Mutation* mutation = pop();
+        if (mutation == nullptr) {
+            this_thread::yield(); // a producer is between its two steps
+            continue;
+        }
+        this->taken++;
+
+        long long record = recordKey(*mutation);
+        taken.push_back({ record, mutation->sequence });
+        if (this->refused.count(record) > 0) {
+            // the id belongs to another process's row, leave that row alone
+            delete mutation;
+            continue;
+        }
+        auto found = saves.find(record);
+        bool isCreate = (mutation->kind == Kind::CreateBoard || mutation->kind == Kind::CreateTask);
+        bool isSave = isCreate || mutation->kind == Kind::SaveBoard || mutation->kind == Kind::SaveTask;
+        if (found != saves.end()) {
+            // the record's earlier save is replaced in its place, so a new board is still
+            // written before its tasks. a save over a create is still inserted.
+            // a delete drops it and goes at the end
+            Mutation* earlier = group[found->second];
+            this->mergedCount++;
+            if (isSave) {
+                if (earlier->kind == Kind::CreateBoard || earlier->kind == Kind::CreateTask) {
+                    mutation->kind = earlier->kind;
+                }
+                delete earlier;
+                group[found->second] = mutation;
+                continue;
+            }
+            delete earlier;
+            group[found->second] = nullptr;
+            saves.erase(found);
+        }
+        if (mutation->kind == Kind::DeleteBoard) {
+            // the board's rows go with it, writing its queued tasks first would only fail
+            // on the missing board and roll the whole group back
+            dropBoardSaves(group, saves, mutation->id);
+        }
+        if (isSave) {
+            saves[record] = group.size();
+        }
+        group.push_back(mutation);
+    }
+
+    try {
+        Database::Batch batch(this->db);
+        for (Mutation* mutation : group) {
+            if (mutation != nullptr) {
+                apply(*mutation);
+            }
+        }
+        batch.commit();
+    }
+    catch (const exception&) {
+        // the group was rolled back. one bad edit shouldn't lose the others, so each is written
+        // again under a savepoint of its own. a failed one is undone alone and the rest still
+        // commit together, the group is never left half written
+        try {
+            Database::Batch batch(this->db);
+            for (Mutation* mutation : group) {
+                if (mutation == nullptr) {
+                    continue;
+                }
+                try {
+                    Database::Savepoint savepoint(this->db);
+                    apply(*mutation);
+                    savepoint.release();
+                }
+                catch (const exception& e) {
+                    if (mutation->kind == Kind::CreateBoard || mutation->kind == Kind::CreateTask) {
+                        this->refused.insert(recordKey(*mutation));
+                    }
+                    lock_guard<mutex> lock(this->wakeMutex);
+                    this->error = e.what();
+                }
+            }
+            batch.commit();
+        }
+        catch (const exception& e) {
+            // the transaction itself failed, nothing of the group was written
+            lock_guard<mutex> lock(this->wakeMutex);
+            this->error = e.what();
+        }
+    }
+    this->commitCount++;
+    for (Mutation* mutation : group) {
+        delete mutation;
+    }
+    settle(taken);
+
+    {
+        lock_guard<mutex> lock(this->wakeMutex);
+        this->written = this->taken;
+    }
+    this->done.notify_all();
+}
+
+void WriteBehind::apply(Mutation& mutation) {
+    switch (mutation.kind) {
+    case Kind::CreateBoard: {
+        Board board(mutation.boardTitle);
+        board.setId(mutation.id);
+        this->db.insertBoard(board);
+        break;
+    }
+    case Kind::SaveBoard: {
+        Board board(mutation.boardTitle);
+        board.setId(mutation.id);
+        this->db.saveBoardData(board);
+        break;
+    }
+    case Kind::DeleteBoard: {
+        Board board(mutation.boardTitle);
+        board.setId(mutation.id);
+        this->db.deleteBoard(board);
+        break;
+    }
+    case Kind::CreateTask:
+        this->db.insertTask(*mutation.task);
+        break;
+    case Kind::SaveTask:
+        this->db.saveTaskData(*mutation.task);
+        break;
+    case Kind::DeleteTask:
+        this->db.deleteTask(*mutation.task);
+        break;
+    }
+}
+
+// the edits of a group are in the database, or failed, readers stop adding them.
+// a record edited again since keeps its newer edit
+void WriteBehind::settle(const vector<pair<long long, long long>>& written) {
+    lock_guard<mutex> lock(this->pendingMutex);
+    for (const auto& edit : written) {
+        auto found = this->pendingSequences.find(edit.first);
+        if (found == this->pendingSequences.end() || found->second != edit.second) {
+            continue;
+        }
+        this->pendingSequences.erase(found);
+        int id = static_cast<int>(edit.first / 2);
+        if (edit.first % 2 == 1) {
+            this->pendingEdits.tasks.erase(id);
+        }
+        else {
+            this->pendingEdits.deletedBoards.erase(id);
+        }
+    }
+}
+
+// drop the queued saves of a board being deleted and of the tasks on it
+void WriteBehind::dropBoardSaves(vector<Mutation*>& group, unordered_map<long long, size_t>& saves, int boardId) {
+    for (auto save = saves.begin(); save != saves.end();) {
+        Mutation* queued = group[save->second];
+        bool onBoard = (queued->task.has_value()) ? (queued->task->getBoardId() == boardId) : (queued->id == boardId);
+        if (onBoard) {
+            delete queued;
+            group[save->second] = nullptr;
+            this->mergedCount++;
+            save = saves.erase(save);
+        }
+        else {
+            save++;
+        }
+    }
+}
+
+// boards and tasks have separate ids, the low bit tells them apart
+long long WriteBehind::recordKey(const Mutation& mutation) {
+    bool isTask = (mutation.kind == Kind::CreateTask || mutation.kind == Kind::SaveTask || mutation.kind == Kind::DeleteTask);
+    return static_cast<long long>(mutation.id) * 2 + (isTask ? 1 : 0);
+}
+
+bool WriteBehind::Pending::touches(int boardId) {
+    for (auto& edit : this->tasks) {
+        if (edit.second.task.getBoardId() == boardId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<int> WriteBehind::Pending::taskIds() {
+    vector<int> ids;
+    for (auto& edit : this->tasks) {
+        ids.push_back(edit.first);
+    }
+    return ids;
+}
+
+// the queued edit of a task, nullptr when it has none
+WriteBehind::Pending::Edit* WriteBehind::Pending::find(int taskId) {
+    auto found = this->tasks.find(taskId);
+    return (found != this->tasks.end()) ? &found->second : nullptr;
+}
+
+// edited tasks placed before a task on a board, to add to a count that left them out
+int WriteBehind::Pending::countBefore(int boardId, Task& task) {
+    int count = 0;
+    for (auto& edit : this->tasks) {
+        Task& edited = edit.second.task;
+        if (!edit.second.deleted && edited.getBoardId() == boardId && edited.getId() != task.getId()
+            && Board::isOrderedBefore(edited, task)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+// lay the edits over a page read from the database that covers the (stage, id) keys first to
+// last of a board: edited tasks leave the page and their queued state goes where it belongs
+void WriteBehind::Pending::merge(vector<Task>& page, int boardId, pair<int, int> first, pair<int, int> last) {
+    if (this->tasks.empty()) {
+        return;
+    }
+    page.erase(remove_if(page.begin(), page.end(), [this](Task& task) { return this->tasks.count(task.getId()) > 0; }), page.end());
+    for (auto& edit : this->tasks) {
+        Task& edited = edit.second.task;
+        pair<int, int> key = { static_cast<int>(edited.getStage()), edited.getId() };
+        if (!edit.second.deleted && edited.getBoardId() == boardId && key >= first && key <= last) {
+            page.push_back(edited);
+        }
+    }
+    sort(page.begin(), page.end(), Board::isOrderedBefore);
+}
+
+// lay the edits over search results. edited tasks that contain every typed word come first,
+// the ranking of the database only covers what it holds
+void WriteBehind::Pending::mergeHits(vector<Database::SearchHit>& hits, const string& text, size_t limit) {
+    if (this->tasks.empty() && this->deletedBoards.empty()) {
+        return;
+    }
+    hits.erase(remove_if(hits.begin(), hits.end(), [this](Database::SearchHit& hit) {
+        return this->tasks.count(hit.taskId) > 0 || this->deletedBoards.count(hit.boardId) > 0;
+    }), hits.end());
+
+    // words split like the search index does, letters, digits and utf-8 bytes
+    vector<string> words;
+    string word;
+    for (size_t i = 0; i <= text.size(); i++) {
+        unsigned char c = (i < text.size()) ? text[i] : ' ';
+        if (isalnum(c) || c >= 0x80) {
+            word += static_cast<char>(tolower(c));
+        }
+        else if (!word.empty()) {
+            words.push_back(move(word));
+            word.clear();
+        }
+    }
+    if (words.empty()) {
+        return;
+    }
+    vector<Database::SearchHit> edited;
+    for (auto& edit : this->tasks) {
+        Task& task = edit.second.task;
+        if (edit.second.deleted || this->deletedBoards.count(task.getBoardId()) > 0) {
+            continue;
+        }
+        string content = task.getTitle() + " " + task.getDescription();
+        transform(content.begin(), content.end(), content.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+        bool matches = all_of(words.begin(), words.end(), [&content](const string& each) { return content.find(each) != string::npos; });
+        if (matches) {
+            edited.push_back({ task.getId(), task.getBoardId(), task.getTitle() });
+        }
+    }
+    hits.insert(hits.begin(), edited.begin(), edited.end());
+    if (hits.size() > limit) {
+        hits.erase(hits.begin() + limit, hits.end());
+    }
+}
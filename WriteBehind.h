@@ -0,0 +1,120 @@
+#ifndef WRITEBEHIND_H
+#define WRITEBEHIND_H
+
+#include "Database.h"
+#include "Board.h"
+#include "Task.h"
+#include "Trace.h"
+#include <iostream>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+// saves edits on a thread with the pool's writer connection, so key handling never waits for the disk.
+// edits go in a lock-free queue, repeated saves of one record are merged and everything
+// queued when the thread wakes is committed as one transaction
+class WriteBehind {
+public:
+    // task edits queued but not written yet. a copy is taken before a read so what is read can
+    // be combined with them, and reads never wait for the writer. an edit written while the
+    // read runs is in both, applying it again changes nothing
+    struct Pending {
+        struct Edit {
+            Task task; // latest queued state, the board it was on for a delete
+            bool deleted;
+        };
+        unordered_map<int, Edit> tasks; // task id to its edit
+        unordered_set<int> deletedBoards;
+
+        bool touches(int boardId);
+        vector<int> taskIds();
+        Edit* find(int taskId);
+        int countBefore(int boardId, Task& task);
+        void merge(vector<Task>& page, int boardId, pair<int, int> first, pair<int, int> last);
+        void mergeHits(vector<Database::SearchHit>& hits, const string& text, size_t limit);
+    };
+
+    WriteBehind(Database& db);
+    ~WriteBehind();
+    // owns a running thread, so copies are not allowed
+    WriteBehind(const WriteBehind&) = delete;
+    WriteBehind& operator=(const WriteBehind&) = delete;
+    int newBoardId();
+    int newTaskId();
+    void createBoard(Board& board);
+    void saveBoard(Board& board);
+    void deleteBoard(Board& board);
+    void createTask(Task& task);
+    void saveTask(Task& task);
+    void deleteTask(Task& task);
+    Pending pending();
+    void flush();
+    bool isIdle();
+    string takeError();
+    long long getCommitCount();
+    long long getMergedCount();
+
+private:
+    enum class Kind { CreateBoard, SaveBoard, DeleteBoard, CreateTask, SaveTask, DeleteTask };
+
+    // one queued edit, saves carry the whole record so the last one of an id wins
+    struct Mutation {
+        Kind kind;
+        int id;
+        string boardTitle;
+        optional<Task> task;
+        atomic<Mutation*> next;
+        long long sequence; // order of pushing, tells the latest edit of a record
+    };
+
+    void push(Mutation* mutation);
+    void link(Mutation* mutation);
+    Mutation* pop();
+    void run();
+    void writeGroup();
+    void apply(Mutation& mutation);
+    void dropBoardSaves(vector<Mutation*>& group, unordered_map<long long, size_t>& saves, int boardId);
+    void settle(const vector<pair<long long, long long>>& written);
+    static long long recordKey(const Mutation& mutation);
+
+    Database& db; // the pool's writer, only used on this thread after construction
+    atomic<int> nextBoardId; // ids are given out here so new records never wait for an insert
+    atomic<int> nextTaskId;
+    // queue of edits, producers swap themselves in at head, the writer takes from tail
+    atomic<Mutation*> head;
+    Mutation* tail;
+    Mutation stub; // keeps the queue from ever being empty of nodes
+    atomic<long long> queued; // edits pushed
+    long long taken; // edits popped, writer thread only
+    atomic<long long> written; // edits committed or merged into a committed one
+    atomic<long long> commitCount; // transactions, read by the stats getters
+    atomic<long long> mergedCount; // saves dropped for a later save of the same record
+    // sleeping and waking only, the queue itself takes no lock
+    mutex wakeMutex;
+    condition_variable wake; // the writer waits here for edits
+    condition_variable done; // flush waits here for the writer
+    atomic<bool> sleeping;
+    bool stopping;
+    string error; // last failed write, guarded by wakeMutex
+    unordered_set<long long> refused; // records whose insert failed, their later edits are dropped. writer thread only
+    // edits not written yet, for reads on other threads. only held to copy or update, never over a write
+    mutex pendingMutex;
+    Pending pendingEdits;
+    unordered_map<long long, long long> pendingSequences; // record to the sequence of its latest edit
+    long long lastSequence; // guarded by pendingMutex
+    thread writer; // started last, after everything it reads is set up
+};
+
+#endif // WRITEBEHIND_H